@@ -0,0 +1,122 @@
+/** \file lcdcanvas.c
+ *  \brief 1 bit per pixel offscreen canvas
+ */
+#include "lcdutils.h"
+#include "lcdcanvas.h"
+
+void canvasClear(Canvas *c, u_char on)
+{
+  u_char fill = on ? 0xff : 0;
+  u_int total = CANVAS_BYTES(c->width, c->height);
+  u_char *p = c->bits;
+  while (total--)
+    *p++ = fill;
+}
+
+void canvasSetPixel(Canvas *c, u_char col, u_char row, u_char on)
+{
+  if (col >= c->width || row >= c->height)
+    return;
+  u_char *p = c->bits + row * CANVAS_STRIDE(c->width) + (col >> 3);
+  u_char mask = 0x80 >> (col & 7);
+  if (on)
+    *p |= mask;
+  else
+    *p &= ~mask;
+}
+
+void canvasFillRect(Canvas *c, u_char colMin, u_char rowMin,
+		    u_char width, u_char height, u_char on)
+{
+  u_char stride = CANVAS_STRIDE(c->width);
+  u_char colLimit = colMin + width, rowLimit = rowMin + height;
+  u_char row, col;
+  if (colLimit > c->width)	/**< clip to canvas */
+    colLimit = c->width;
+  if (rowLimit > c->height)
+    rowLimit = c->height;
+  u_char *rowBits = c->bits + rowMin * stride;
+  for (row = rowMin; row < rowLimit; row++, rowBits += stride) {
+    for (col = colMin; col < colLimit; col++) {
+      u_char mask = 0x80 >> (col & 7);
+      if (on)
+	rowBits[col >> 3] |= mask;
+      else
+	rowBits[col >> 3] &= ~mask;
+    }
+  }
+}
+
+void canvasRectOutline(Canvas *c, u_char colMin, u_char rowMin,
+		       u_char width, u_char height, u_char on)
+{
+  /**< top & bot */
+  canvasFillRect(c, colMin, rowMin, width, 1, on);
+  canvasFillRect(c, colMin, rowMin + height, width, 1, on);
+
+  /**< left & right */
+  canvasFillRect(c, colMin, rowMin, 1, height, on);
+  canvasFillRect(c, colMin + width, rowMin, 1, height, on);
+}
+
+void canvasDrawChar5x7(Canvas *c, u_char rcol, u_char rrow, char ch)
+{
+  u_char col = 0;
+  u_char row = 0;
+  u_char bit = 0x01;
+  u_char oc = ch - 0x20;
+
+  while (row < 8) {
+    while (col < 5) {
+      canvasSetPixel(c, rcol + col, rrow + row, font_5x7[oc][col] & bit);
+      col++;
+    }
+    col = 0;
+    bit <<= 1;
+    row++;
+  }
+}
+
+void canvasDrawString5x7(Canvas *c, u_char col, u_char row, char *string)
+{
+  u_char cols = col;
+  while (*string) {
+    canvasDrawChar5x7(c, cols, row, *string++);
+    cols += 6;
+  }
+}
+
+void canvasDrawIcon(Canvas *c, u_char col, u_char row,
+		    const u_char *icon, u_char width, u_char height)
+{
+  u_char stride = CANVAS_STRIDE(width);
+  u_char r, k;
+  for (r = 0; r < height; r++, icon += stride) {
+    for (k = 0; k < width; k++) {
+      if (icon[k >> 3] & (0x80 >> (k & 7)))
+	canvasSetPixel(c, col + k, row + r, 1);
+    }
+  }
+}
+
+void canvasBlit(const Canvas *c, u_char col, u_char row,
+		u_int fgColorBGR, u_int bgColorBGR)
+{
+  u_char stride = CANVAS_STRIDE(c->width);
+  const u_char *rowBits = c->bits;
+  u_char r, k;
+
+  lcd_setArea(col, row, col + c->width - 1, row + c->height - 1);
+  for (r = 0; r < c->height; r++, rowBits += stride) {
+    const u_char *p = rowBits;
+    u_char bits = 0, mask = 0;
+    for (k = 0; k < c->width; k++) {
+      if (!mask) {		/**< next byte of this row */
+	bits = *p++;
+	mask = 0x80;
+      }
+      lcd_writeColor((bits & mask) ? fgColorBGR : bgColorBGR);
+      mask >>= 1;
+    }
+  }
+}
@@ -0,0 +1,78 @@
+/** \file lcdcanvas.h
+ *  \brief A 1 bit per pixel offscreen canvas.
+ *
+ *  Composite elements (outlines, text, icons) are drawn into RAM
+ *  and then sent to the lcd in a single window by canvasBlit.
+ */
+
+#ifndef lcdcanvas_included
+#define lcdcanvas_included
+
+#include "lcdutils.h"
+
+/** Offscreen canvas, one bit per pixel.
+ *
+ *  Rows are stored top to bottom, each padded to a whole byte.
+ *  Within a byte the most significant bit is the leftmost pixel.
+ */
+typedef struct {
+  u_char width, height;		/**< in pixels */
+  u_char *bits;			/**< CANVAS_BYTES(width, height) bytes */
+} Canvas;
+
+/** Bytes per canvas row */
+#define CANVAS_STRIDE(width) (((width) + 7) >> 3)
+
+/** Bytes of storage required by a width x height canvas */
+#define CANVAS_BYTES(width, height) (CANVAS_STRIDE(width) * (height))
+
+/** Define a canvas named name along with its (static) storage.
+ *  Size it to fit the element being composed: 512 bytes of RAM are
+ *  shared with everything else on the msp430g2553.
+ */
+#define CANVAS_DEFINE(name, width, height)			\
+  static u_char name##_bits[CANVAS_BYTES(width, height)];	\
+  Canvas name = {width, height, name##_bits}
+
+/** Set every pixel of the canvas to on (1) or off (0) */
+void canvasClear(Canvas *c, u_char on);
+
+/** Set a single pixel.  Pixels outside the canvas are ignored. */
+void canvasSetPixel(Canvas *c, u_char col, u_char row, u_char on);
+
+/** Fill rectangle (clipped to the canvas)
+ *
+ *  \param colMin Column start
+ *  \param rowMin Row start
+ *  \param width Width of rectangle
+ *  \param height Height of rectangle
+ *  \param on 1 to set pixels, 0 to clear them
+ */
+void canvasFillRect(Canvas *c, u_char colMin, u_char rowMin,
+		    u_char width, u_char height, u_char on);
+
+/** Draw rectangle outline, with the same extent as drawRectOutline
+ */
+void canvasRectOutline(Canvas *c, u_char colMin, u_char rowMin,
+		       u_char width, u_char height, u_char on);
+
+/** 5x7 font - background pixels of the 5x8 cell are cleared */
+void canvasDrawChar5x7(Canvas *c, u_char col, u_char row, char ch);
+
+/** Draw string at col,row using the 5x7 font */
+void canvasDrawString5x7(Canvas *c, u_char col, u_char row, char *string);
+
+/** Draw an icon: a 1 bpp bitmap in canvas layout (rows padded to
+ *  whole bytes, msb leftmost).  Set bits are drawn, clear bits are
+ *  left untouched.
+ */
+void canvasDrawIcon(Canvas *c, u_char col, u_char row,
+		    const u_char *icon, u_char width, u_char height);
+
+/** Send the canvas to the lcd as a single window at col,row,
+ *  expanding set bits to fgColorBGR and clear bits to bgColorBGR.
+ */
+void canvasBlit(const Canvas *c, u_char col, u_char row,
+		u_int fgColorBGR, u_int bgColorBGR);
+
+#endif // included
@@ -31,10 +31,7 @@ void fillRectangle(u_char colMin, u_char rowMin, u_char width, u_char height,
   u_char colLimit = colMin + width, rowLimit = rowMin + height;
   lcd_setArea(colMin, rowMin, colLimit - 1, rowLimit - 1);
   u_int total = width * height;
-  u_int c = 0;
-  while ((c++) < total) {
-    lcd_writeColor(colorBGR);
-  }
+  lcd_writeColorRun(colorBGR, total);
 }
 
 /** Clear screen (fill with color)
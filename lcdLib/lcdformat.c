@@ -0,0 +1,113 @@
+/** \file lcdformat.c
+ *  \brief Division-free integer formatting
+ */
+#include "lcdutils.h"
+#include "lcdformat.h"
+
+/* right align the len characters of digits (sign first, if any) in s;
+ * the padding goes between sign and digits when zero padding */
+static u_char
+fmtPlace(char *s, const char *digits, u_char len, u_char width,
+	 u_char flags, u_char sign)
+{
+  u_char i = 0, pad;
+  if (!width)
+    width = len;
+  if (len > width) {		/* too wide: don't overrun s */
+    while (i < width)
+      s[i++] = '#';
+  } else {
+    pad = width - len;
+    if (flags & FMT_ZERO_PAD) {
+      if (sign)
+	s[i++] = *digits++, len--;
+      while (pad--)
+	s[i++] = '0';
+    } else
+      while (pad--)
+	s[i++] = ' ';
+    while (len--)
+      s[i++] = *digits++;
+  }
+  s[i] = '\0';
+  return i;
+}
+
+/* digits of n, most significant first, no leading zeros */
+static u_char
+fmtDigits(char *d, u_int n)
+{
+  static const u_int pow10[] = {10000, 1000, 100, 10};
+  u_char len = 0, i;
+  for (i = 0; i < 4; i++) {
+    char digit = '0';
+    while (n >= pow10[i]) {	/* subtract, don't divide */
+      n -= pow10[i];
+      digit++;
+    }
+    if (len || digit != '0')
+      d[len++] = digit;
+  }
+  d[len++] = '0' + n;		/* units: always shown */
+  return len;
+}
+
+u_char
+fmtUnsigned(char *s, u_int n, u_char width, u_char flags)
+{
+  char d[FMT_DEC_MAX];
+  return fmtPlace(s, d, fmtDigits(d, n), width, flags, 0);
+}
+
+u_char
+fmtSigned(char *s, int n, u_char width, u_char flags)
+{
+  char d[FMT_DEC_MAX];
+  if (n >= 0)
+    return fmtPlace(s, d, fmtDigits(d, n), width, flags, 0);
+  d[0] = '-';
+  return fmtPlace(s, d, fmtDigits(d + 1, -(u_int)n) + 1, width, flags, 1);
+}
+
+u_char
+fmtHex(char *s, unsigned long n, u_char digits)
+{
+  u_char i = digits;
+  s[i] = '\0';
+  while (i--) {
+    u_char nibble = n & 0xf;
+    s[i] = nibble < 10 ? '0' + nibble : 'a' + nibble - 10;
+    n >>= 4;
+  }
+  return digits;
+}
+
+void
+bcdIncrement(BcdCounter *c)
+{
+  u_int v = *c;
+  u_char shift;
+  for (shift = 0; shift < 16; shift += 4) {
+    if (((v >> shift) & 0xf) != 9) {
+      v += 1u << shift;		/* no carry out of this digit */
+      break;
+    }
+    v &= ~(0xfu << shift);	/* 9 rolls over to 0: carry on */
+  }
+  *c = v;
+}
+
+u_char
+fmtBcd(char *s, BcdCounter c, u_char width, u_char flags)
+{
+  char d[4];
+  u_char len = 0, shift = 16;
+  while (shift) {
+    char digit;
+    shift -= 4;
+    digit = '0' + ((c >> shift) & 0xf);
+    if (len || digit != '0' || !shift)
+      d[len++] = digit;
+  }
+  return fmtPlace(s, d, len, width, flags, 0);
+}
@@ -0,0 +1,47 @@
+/** \file lcdformat.h
+ *  \brief Integer formatting for on-screen numbers, without division.
+ *
+ *  The msp430g2553 has neither a hardware multiplier nor a divider, so
+ *  % 10 and / 10 are each a libgcc call looping over the bits.  These
+ *  format by subtracting powers of ten (at most 9 subtractions per
+ *  digit) or read packed BCD digits directly.
+ *
+ *  Each writes its digits right aligned in width characters (or as
+ *  many as needed if width is 0) followed by '\0', so s needs width+1
+ *  bytes (FMT_DEC_MAX+1 for width 0).  A number wider than width is
+ *  shown as width '#'s rather than overrunning s.  Each returns the
+ *  number of characters written, not counting the '\0'.
+ */
+
+#ifndef lcdformat_included
+#define lcdformat_included
+
+#include "lcdutils.h"
+
+#define FMT_DEC_MAX 6		/**< widest decimal int: sign and 5 digits */
+
+/** Flags */
+#define FMT_ZERO_PAD 1		/**< pad with '0' (after any sign), not ' ' */
+
+/** Unsigned decimal */
+u_char fmtUnsigned(char *s, u_int n, u_char width, u_char flags);
+
+/** Signed decimal */
+u_char fmtSigned(char *s, int n, u_char width, u_char flags);
+
+/** The last (low-order) hex digits of n, as many as digits, in lower case */
+u_char fmtHex(char *s, unsigned long n, u_char digits);
+
+/** Packed BCD counter: 4 decimal digits, the least significant in the
+ *  low nibble, so it can be shown without converting it.  Start it at
+ *  0 (or BCD constants such as 0x42 for 42).
+ */
+typedef u_int BcdCounter;
+
+/** Add one in place, carrying from digit to digit; 9999 wraps to 0 */
+void bcdIncrement(BcdCounter *c);
+
+/** Decimal digits of c, without leading zeros unless FMT_ZERO_PAD */
+u_char fmtBcd(char *s, BcdCounter c, u_char width, u_char flags);
+
+#endif // included
@@ -10,6 +10,7 @@
  
 #include "lcdutils.h"
 #include "msp430.h"
+#include "libTimer.h"
 
 u_char _orientation = 0;
 
@@ -47,7 +48,9 @@ u_char _orientation = 0;
 #define CASETP							0x2A
 #define PASETP							0x2B
 #define RAMWRP							0x2C
+#define VSCRDEF							0x33
 #define	MADCTL							0x36
+#define VSCSAD							0x37
 #define	COLMOD							0x3A
 #define GMCTRP1							0xE0
 #define GMCTRN1							0xE1
@@ -70,7 +73,7 @@ static void setUpSPIforLCD() {
   UCB0CTL1 |= UCSWRST;
   UCB0CTL0 = UCCKPH + UCMSB + UCMST + UCSYNC; /**< 3-pin, 8-bit SPI master */
   UCB0CTL1 |= UCSSEL_2; /**< SMCLK */
-  UCB0BR0 |= 0x01; /**< 1:1 */
+  UCB0BR0 = clockSpiDivider; /**< SMCLK / divider, per clock profile */
   UCB0BR1 = 0;
   UCB0CTL1 &= ~UCSWRST;
   LCD_SELECT();
@@ -87,11 +90,136 @@ lcd_writeData(u_char data)
   UCB0TXBUF = data;		/**< send data */
 }
 
+/** Send one byte of a data burst: D/C must already be high.
+ *  Loads as soon as the transmit buffer frees rather than waiting
+ *  for the previous byte to finish shifting out.
+ */
+static inline void
+lcd_burstByte(u_char data)
+{
+  while (!(IFG2 & UCB0TXIFG));
+  UCB0TXBUF = data;
+}
+
+/** Start a data burst */
+static inline void
+lcd_burstBegin()
+{
+  while (UCB0STAT & UCBUSY);	/**< wait for previous transfer to complete */
+  LCD_DC_HI();			/**< every byte of the burst is data */
+}
+
+const u_int lcd_defaultPalette[LCD_PALETTE_SIZE] = {
+  COLOR_BLACK, COLOR_WHITE, COLOR_RED, COLOR_GREEN,
+  COLOR_BLUE, COLOR_YELLOW, COLOR_CYAN, COLOR_MAGENTA,
+  COLOR_ORANGE, COLOR_GRAY, COLOR_NAVY, COLOR_DARK_GREEN,
+  COLOR_PINK, COLOR_VIOLET, COLOR_BROWN, COLOR_SKY_BLUE
+};
+const u_int *lcd_palette = lcd_defaultPalette;
+static u_int *_paletteRam;	/**< set by lcd_usePalette */
+
+#ifdef LCD_COLOR_12BIT
+
+/** 5-6-5 BGR to 4-4-4 BGR (the top 4 bits of each component) */
+static inline u_int
+bgr12(u_int c)
+{
+  return ((c >> 4) & 0xf00) | ((c >> 3) & 0x0f0) | ((c >> 1) & 0x00f);
+}
+
+static u_int _areaRemaining;	/**< pixels not yet written to the area */
+static u_int _pendingColor;	/**< 12 bit color waiting for its pair */
+static u_char _pending;		/**< true if _pendingColor is valid */
+
+/** Write the first pixel of a pair alone (2 bytes, low nibble unused) */
+static void
+lcd_flushPending()
+{
+  if (_pending) {
+    lcd_burstBegin();
+    lcd_burstByte(_pendingColor >> 4);
+    lcd_burstByte(_pendingColor << 4);
+    _pending = 0;
+  }
+}
+
+/** Queue a 12 bit pixel; pairs are sent as 3 bytes.
+ *  The burst must already have begun.
+ */
+static inline void
+lcd_pixel12(u_int c12)
+{
+  if (_pending) {
+    lcd_burstByte(_pendingColor >> 4);
+    lcd_burstByte((_pendingColor << 4) | (c12 >> 8));
+    lcd_burstByte(c12);
+    _pending = 0;
+  } else if (_areaRemaining <= 1) { /**< odd pixel that ends the area */
+    lcd_burstByte(c12 >> 4);
+    lcd_burstByte(c12 << 4);
+  } else {
+    _pendingColor = c12;
+    _pending = 1;
+  }
+  _areaRemaining--;
+}
+
+void lcd_writeColor(u_int colorBGR)
+{
+  lcd_burstBegin();
+  lcd_pixel12(bgr12(colorBGR));
+}
+
+void lcd_writeColors(const u_int *colorsBGR, u_int count)
+{
+  lcd_burstBegin();
+  while (count--)
+    lcd_pixel12(bgr12(*colorsBGR++));
+}
+
+void lcd_writeIndices(const u_char *indices, u_int count)
+{
+  lcd_burstBegin();
+  while (count--)
+    lcd_pixel12(bgr12(lcd_palette[*indices++]));
+}
+
+void lcd_writeColorRun(u_int colorBGR, u_int count)
+{
+  u_int c12 = bgr12(colorBGR);
+  u_char b0 = c12 >> 4, b1 = (c12 << 4) | (c12 >> 8), b2 = c12;
+
+  lcd_burstBegin();
+  if (_pending && count) {	/**< complete a pair left by a prior write */
+    lcd_pixel12(c12);
+    count--;
+  }
+  _areaRemaining -= count & ~1;
+  for (; count > 1; count -= 2) { /**< two pixels per 3 bytes */
+    lcd_burstByte(b0);
+    lcd_burstByte(b1);
+    lcd_burstByte(b2);
+  }
+  if (count)
+    lcd_pixel12(c12);
+}
+
+#else /* 16 bit color */
+
 typedef union {
   u_char colorBytes[2];
   u_int colorBGRWord;
 } ColorBGR;
 
+/** Send one 16 bit color within a burst */
+static inline void
+lcd_burstColor(u_int colorBGR)
+{
+  ColorBGR colorU = {.colorBGRWord = colorBGR};
+  lcd_burstByte(colorU.colorBytes[1]);
+  lcd_burstByte(colorU.colorBytes[0]);
+}
+
 void lcd_writeColor(u_int colorBGR)
 {
   ColorBGR colorU = {.colorBGRWord = colorBGR};
@@ -99,9 +227,49 @@ void lcd_writeColor(u_int colorBGR)
   lcd_writeData(colorU.colorBytes[0]);
 }
 
+void lcd_writeColors(const u_int *colorsBGR, u_int count)
+{
+  lcd_burstBegin();
+  while (count--)
+    lcd_burstColor(*colorsBGR++);
+}
+
+void lcd_writeIndices(const u_char *indices, u_int count)
+{
+  lcd_burstBegin();
+  while (count--)
+    lcd_burstColor(lcd_palette[*indices++]);
+}
+
+void lcd_writeColorRun(u_int colorBGR, u_int count)
+{
+  lcd_burstBegin();
+  while (count--)
+    lcd_burstColor(colorBGR);
+}
+
+#endif /* LCD_COLOR_12BIT */
+
+void lcd_usePalette(u_int *table)
+{
+  u_char i;
+  for (i = 0; i < LCD_PALETTE_SIZE; i++)
+    table[i] = lcd_palette[i];
+  lcd_palette = _paletteRam = table;
+}
+
+void lcd_setPalette(u_char index, u_int colorBGR)
+{
+  if (_paletteRam && index < LCD_PALETTE_SIZE)
+    _paletteRam[index] = colorBGR;
+}
+
 /** Write command to LCD (private) */
 void _writeCommand(u_char command) 
 {
+#ifdef LCD_COLOR_12BIT
+  lcd_flushPending();		/**< else the pixel would follow as a parameter */
+#endif
   while (UCB0STAT & UCBUSY);	/**< wait for previous transfer to complete */
   LCD_DC_LO();			          /**< specify sending a command */
   UCB0TXBUF = command;		    /**< send command */
@@ -118,6 +286,9 @@ void _delay(u_char x10ms) {
 /** Set area to draw to */
 void lcd_setArea(u_char colStart, u_char rowStart, u_char colEnd, u_char rowEnd) 
 {
+#ifdef LCD_COLOR_12BIT
+	_areaRemaining = (colEnd - colStart + 1) * (rowEnd - rowStart + 1);
+#endif
 	_writeCommand(CASETP);
 	lcd_writeData(0);
 	lcd_writeData(colStart);
@@ -131,16 +302,77 @@ void lcd_setArea(u_char colStart, u_char rowStart, u_char colEnd, u_char rowEnd)
 	_writeCommand(RAMWRP);
 }
 
-/** Initialize onboard LCD */
-void lcd_init() 
+u_char lcd_scrollTop = 0, lcd_scrollLines = 0, lcd_scrollOffset = 0;
+
+/** Define the scrolling band */
+void lcd_setScrollArea(u_char topFixed, u_char scrollLines)
 {
-  setUpSPIforLCD();
-  _writeCommand(SWRESET);  /**< software reset */
-  _delay(20);
-  _writeCommand(SLEEPOUT); /**< exit sleep */
-  _delay(20);
+  u_char bottomFixed = LCD_FRAME_ROWS - topFixed - scrollLines;
+  _writeCommand(VSCRDEF);
+  lcd_writeData(0);
+  lcd_writeData(topFixed);
+  lcd_writeData(0);
+  lcd_writeData(scrollLines);
+  lcd_writeData(0);
+  lcd_writeData(bottomFixed);
+  lcd_scrollTop = topFixed;
+  lcd_scrollLines = scrollLines;
+  lcd_setScrollOffset(0);
+}
+
+/** Set the band's scroll offset */
+void lcd_setScrollOffset(u_char offset)
+{
+  u_int startRow;
+  if (!lcd_scrollLines)
+    offset = 0;
+  else
+    while (offset >= lcd_scrollLines)
+      offset -= lcd_scrollLines;
+  startRow = lcd_scrollTop + offset;
+  _writeCommand(VSCSAD);
+  lcd_writeData(startRow >> 8);
+  lcd_writeData(startRow);
+  lcd_scrollOffset = offset;
+}
+
+/** Frame memory row displayed at screen row */
+u_char lcd_scrollRow(u_char row)
+{
+  u_int i = row - lcd_scrollTop;
+  if (row < lcd_scrollTop || i >= lcd_scrollLines)
+    return row;			/**< in a fixed area */
+  i += lcd_scrollOffset;
+  if (i >= lcd_scrollLines)
+    i -= lcd_scrollLines;
+  return lcd_scrollTop + i;
+}
+
+/** Rows from row to rowEnd that are contiguous in frame memory */
+u_char lcd_scrollRun(u_char row, u_char rowEnd)
+{
+  u_char run = rowEnd - row + 1, limit = run;
+  u_int bandEnd = lcd_scrollTop + lcd_scrollLines;
+  if (row < lcd_scrollTop) {
+    limit = lcd_scrollTop - row; /**< stop where the band starts */
+  } else if (row < bandEnd) {
+    u_char toWrap = bandEnd - lcd_scrollRow(row);
+    u_char toEdge = bandEnd - row;
+    limit = toWrap < toEdge ? toWrap : toEdge;
+  }
+  return run < limit ? run : limit;
+}
+
+/** Configure color format and orientation, display on (private) */
+static void lcd_configure()
+{
+#ifdef LCD_COLOR_12BIT
+  _writeCommand(COLMOD);   /**< Set Color Format 12bit */
+  lcd_writeData(0x03);
+#else
   _writeCommand(COLMOD);   /**< Set Color Format 16bit */
   lcd_writeData(0x05);
+#endif
   _writeCommand(DISPON);   /**< display ON */
 
   _writeCommand(MADCTL);
@@ -159,3 +391,52 @@ void lcd_init()
   }
 }
 
+/** Initialize onboard LCD */
+void lcd_init() 
+{
+  setUpSPIforLCD();
+  _writeCommand(SWRESET);  /**< software reset */
+  _delay(20);
+  _writeCommand(SLEEPOUT); /**< exit sleep */
+  _delay(20);
+  lcd_configure();
+}
+
+/** Phases of non-blocking initialization */
+static enum {
+  LCD_INIT_IDLE, LCD_INIT_RESET, LCD_INIT_SLEEPOUT, LCD_INIT_READY
+} _initPhase = LCD_INIT_IDLE;
+static u_char _initWait;	/**< ticks left in the current phase */
+
+/** Start non-blocking initialization */
+void lcd_initBegin()
+{
+  setUpSPIforLCD();
+  _writeCommand(SWRESET);  /**< software reset */
+  _initWait = LCD_INIT_WAIT_TICKS;
+  _initPhase = LCD_INIT_RESET;
+}
+
+/** Advance non-blocking initialization by one tick */
+int lcd_initTick()
+{
+  if (_initPhase == LCD_INIT_RESET || _initPhase == LCD_INIT_SLEEPOUT) {
+    if (--_initWait)
+      return 0;
+    if (_initPhase == LCD_INIT_RESET) {
+      _writeCommand(SLEEPOUT); /**< exit sleep */
+      _initWait = LCD_INIT_WAIT_TICKS;
+      _initPhase = LCD_INIT_SLEEPOUT;
+    } else {
+      lcd_configure();
+      _initPhase = LCD_INIT_READY;
+    }
+  }
+  return _initPhase == LCD_INIT_READY;
+}
+
+/** True once non-blocking initialization has completed */
+int lcd_ready()
+{
+  return _initPhase == LCD_INIT_READY;
+}
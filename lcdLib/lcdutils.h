@@ -38,9 +38,28 @@ extern const unsigned int colors[43];
 # define screenWidth LONG_EDGE_PIXELS
 #endif
 
-/** Initialize the onboard LCD */
+/** Initialize the onboard LCD
+ *
+ *  Busy-waits for about 400ms while the controller resets and wakes.
+ */
 void lcd_init();
 
+/** Non-blocking initialization
+ *
+ *  lcd_initBegin starts the same sequence as lcd_init.  Call
+ *  lcd_initTick from a periodic interrupt (e.g. the watchdog timer
+ *  handler); it performs reset, sleep-out and configuration in phases
+ *  LCD_INIT_WAIT_TICKS apart and returns true once the lcd is ready.
+ *  Meanwhile the CPU is free for other setup; nothing else may be
+ *  sent to the lcd until lcd_ready returns true.
+ */
+#ifndef LCD_INIT_WAIT_TICKS
+#define LCD_INIT_WAIT_TICKS 50	/**< 200ms at timerLib's 250Hz tick */
+#endif
+void lcd_initBegin();
+int lcd_initTick();
+int lcd_ready();
+
 /** Set area to draw to
  *  
  *  \param colStart Start column of the area
@@ -56,6 +75,114 @@ void lcd_setArea(u_char colStart, u_char rowStart, u_char colEnd, u_char rowEnd)
  */
 void lcd_writeColor(u_int colorBGR);
 
+/** Write a run of colors to LCD in a single burst
+ *
+ *  Rather than waiting for each byte to finish shifting out, the
+ *  next byte is loaded as soon as the transmit buffer is free.
+ *  The last byte is still shifting when this returns, so callers
+ *  can compute the next run in parallel.
+ *
+ *  \param colorsBGR The colors in BGR
+ *  \param count Number of colors
+ */
+void lcd_writeColors(const u_int *colorsBGR, u_int count);
+
+/** Write count pixels of a single color to LCD in a single burst
+ *
+ *  \param colorBGR The color in BGR
+ *  \param count Number of pixels
+ */
+void lcd_writeColorRun(u_int colorBGR, u_int count);
+
+/** Write a run of palette-indexed pixels to LCD in a single burst
+ *
+ *  \param indices Indices into lcd_palette
+ *  \param count Number of pixels
+ */
+void lcd_writeIndices(const u_char *indices, u_int count);
+
+/** Palette
+ *
+ *  Palette-indexed pixels take one byte per pixel in RAM.
+ *  The palette is lcd_defaultPalette, in flash, with the LCD_PAL_
+ *  colors below, so it costs no RAM unless a program opts in to
+ *  changing it with lcd_usePalette.
+ */
+#define LCD_PALETTE_SIZE 16
+extern const u_int lcd_defaultPalette[LCD_PALETTE_SIZE];
+extern const u_int *lcd_palette; /**< the palette in use */
+
+/** Use table (LCD_PALETTE_SIZE entries of the caller's RAM) as the
+ *  palette, starting as a copy of the current one */
+void lcd_usePalette(u_int *table);
+
+/** Set palette entry index to colorBGR (ignored until lcd_usePalette) */
+void lcd_setPalette(u_char index, u_int colorBGR);
+
+/** Default palette indices */
+#define LCD_PAL_BLACK		0
+#define LCD_PAL_WHITE		1
+#define LCD_PAL_RED		2
+#define LCD_PAL_GREEN		3
+#define LCD_PAL_BLUE		4
+#define LCD_PAL_YELLOW		5
+#define LCD_PAL_CYAN		6
+#define LCD_PAL_MAGENTA		7
+#define LCD_PAL_ORANGE		8
+#define LCD_PAL_GRAY		9
+#define LCD_PAL_NAVY		10
+#define LCD_PAL_DARK_GREEN	11
+#define LCD_PAL_PINK		12
+#define LCD_PAL_VIOLET		13
+#define LCD_PAL_BROWN		14
+#define LCD_PAL_SKY_BLUE	15
+
+/** Vertical scrolling
+ *
+ *  The panel can scroll a band of rows in hardware: rows
+ *  [topFixed, topFixed + scrollLines) scroll while the rows above and
+ *  below stay fixed.  With offset k, screen row topFixed + i of the
+ *  band shows frame memory row topFixed + (i + k) % scrollLines.
+ *
+ *  lcd_setArea addresses frame memory rows.  Use lcd_scrollRow to
+ *  find the memory row shown at a screen row, and lcd_scrollRun to
+ *  find how many following rows are contiguous in memory (a window
+ *  may not cross the point where the band wraps).  Rows follow the
+ *  screen's rows in the vertical orientations.
+ */
+#ifndef LCD_FRAME_ROWS
+#define LCD_FRAME_ROWS LONG_EDGE_PIXELS	/**< 162 on some ST7735 modules */
+#endif
+
+extern u_char lcd_scrollTop, lcd_scrollLines, lcd_scrollOffset;
+
+/** Define the scrolling band and reset its offset to 0
+ *
+ *  \param topFixed Rows fixed at the top
+ *  \param scrollLines Rows in the scrolling band; the rest are fixed at the bottom
+ */
+void lcd_setScrollArea(u_char topFixed, u_char scrollLines);
+
+/** Set the band's scroll offset (one command, no pixels are sent) */
+void lcd_setScrollOffset(u_char offset);
+
+/** Frame memory row displayed at screen row */
+u_char lcd_scrollRow(u_char row);
+
+/** Number of rows, starting at row and at most up to rowEnd, that are
+ *  contiguous in frame memory
+ */
+u_char lcd_scrollRun(u_char row, u_char rowEnd);
+
+/** Color depth
+ *
+ *  By default the panel runs with 16 bits (2 bytes) per pixel.
+ *  Building lcdLib with LCD_COLOR_12BIT defined selects 12 bits per
+ *  pixel: pixels are sent in pairs packed into 3 bytes, cutting pixel
+ *  traffic by 25%.  Colors are still specified as 16 bit BGR values;
+ *  the low bits of each component are dropped.
+ */
+
 #define rgb2bgr(val) ((((val) << 11)&0xf800) | ((val)&0x7e0) | (((val)>>11)&0x1f))
 
 /** Colors */
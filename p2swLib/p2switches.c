@@ -5,13 +5,56 @@ static unsigned char switch_mask;
 static unsigned char switches_last_reported;
 static unsigned char switches_current;
 
+volatile unsigned int p2sw_now;
+P2swLatency p2swLatency;
+unsigned char p2swDropped;
+
+static P2swEvent events[P2SW_EVENTS];
+static volatile unsigned char head, tail; /**< written only by handlers, only by main */
+
+static unsigned char ticking;	/**< p2sw_tick is being called: debounce */
+static unsigned char locked;	/**< switches ignored while they bounce */
+static unsigned char lockTicks[8];
+
 static void
 switch_update_interrupt_sense()
 {
-  switches_current = P2IN & switch_mask;
+  unsigned char levels = P2IN & switch_mask;
   /* update switch interrupt to detect changes from current buttons */
-  P2IES |= (switches_current);  /* if switch up, sense down */
-  P2IES &= (switches_current | ~switch_mask); /* if switch down, sense up */
+  P2IES |= (levels);  /* if switch up, sense down */
+  P2IES &= (levels | ~switch_mask); /* if switch down, sense up */
+}
+
+/** From handlers: queue an event for each switch in bits whose level
+ *  differs from switches_current, then ignore it while it bounces.
+ *  Returns the switches that changed. */
+static unsigned char
+switch_changes(unsigned char bits)
+{
+  unsigned char changed = (P2IN ^ switches_current) & bits;
+  unsigned char result = changed;
+  unsigned char i, bit;
+
+  for (i = 0, bit = 1; changed; i++, bit <<= 1) {
+    if (!(changed & bit))
+      continue;
+    changed &= ~bit;
+    switches_current ^= bit;
+    if ((unsigned char)(head - tail) < P2SW_EVENTS) {
+      P2swEvent *e = &events[head & (P2SW_EVENTS - 1)];
+      e->sw = bit;
+      e->down = !(switches_current & bit); /* pulled up: 0 is down */
+      e->time = p2sw_now;
+      head++;			/* publish after the event is written */
+    } else if (p2swDropped < 255)
+      p2swDropped++;
+    if (ticking) {
+      locked |= bit;
+      P2IE &= ~bit;
+      lockTicks[i] = P2SW_DEBOUNCE_TICKS;
+    }
+  }
+  return result;
 }
 
 void 
@@ -24,6 +67,7 @@ p2sw_init(unsigned char mask)
   P2DIR &= ~mask;   /* set switches' bits for input */
 
   switch_update_interrupt_sense();
+  switches_current = P2IN & mask;
 }
 
 /* Returns a word where:
@@ -37,11 +81,82 @@ p2sw_read() {
   return switches_current | (sw_changed << 8);
 }
 
+/** Re-arm switches that were being debounced and catch any change
+ *  they made while locked */
+static void
+switch_unlock(unsigned char unlocked)
+{
+  switch_update_interrupt_sense();
+  P2IFG &= ~unlocked;
+  P2IE |= unlocked;
+  switch_changes(unlocked);
+}
+
+unsigned char
+p2sw_tick()
+{
+  unsigned char i, bit, unlocked = 0;
+
+  p2sw_now++;
+  ticking = 1;
+  for (i = 0, bit = 1; locked; i++, bit <<= 1) {
+    if ((locked & bit) && !--lockTicks[i]) {
+      locked &= ~bit;
+      unlocked |= bit;
+    }
+    if (bit == 0x80)
+      break;
+  }
+  if (unlocked)			/* settled: catch changes made while locked */
+    switch_unlock(unlocked);
+  return unlocked;
+}
+
+void
+p2sw_tickStop()
+{
+  unsigned char unlocked = locked;
+  ticking = 0;			/* nothing would unlock a switch now */
+  locked = 0;
+  if (unlocked)
+    switch_unlock(unlocked);
+}
+
+int
+p2sw_pending()
+{
+  return head != tail;
+}
+
+int
+p2sw_settled()
+{
+  return !locked;
+}
+
+int
+p2sw_pop(P2swEvent *e)
+{
+  unsigned int latency;
+  if (head == tail)
+    return 0;
+  *e = events[tail & (P2SW_EVENTS - 1)];
+  tail++;			/* free the slot after copying it */
+  latency = p2sw_now - e->time;
+  p2swLatency.events++;
+  p2swLatency.total += latency;
+  if (latency > p2swLatency.max)
+    p2swLatency.max = latency > 255 ? 255 : latency;
+  return 1;
+}
+
 /* Switch on P2 (S1) */
 void
 __interrupt_vec(PORT2_VECTOR) Port_2(){
   if (P2IFG & switch_mask) {  /* did a button cause this interrupt? */
     P2IFG &= ~switch_mask;	/* clear pending sw interrupts */
     switch_update_interrupt_sense();
+    if (switch_changes(switch_mask & ~locked))
+      __bic_SR_register_on_exit(LPM4_bits); /* wake main for the event */
   }
 }
@@ -6,4 +6,59 @@
 unsigned int p2sw_read();
 void p2sw_init(unsigned char mask);
 
+/** Switch events
+ *
+ *  The Port 2 interrupt queues a press or release as soon as a switch
+ *  changes, stamped with the tick count, and wakes main from any low
+ *  power mode.  Programs that call p2sw_tick
+ *  from their tick handler also get debouncing: after each change the
+ *  switch is ignored for P2SW_DEBOUNCE_TICKS ticks and then re-read.
+ */
+
+#ifndef P2SW_EVENTS
+#define P2SW_EVENTS 4		/**< ring size (a power of 2), 4 bytes each */
+#endif
+#define P2SW_DEBOUNCE_TICKS 5	/**< 20ms at 250 ticks/sec */
+
+typedef struct {
+  unsigned char sw;		/**< the switch's bit (BIT0 ...) */
+  unsigned char down;		/**< 1 pressed, 0 released */
+  unsigned int time;		/**< p2sw_now when it happened */
+} P2swEvent;
+
+/** Ticks between events being queued and popped */
+typedef struct {
+  unsigned int events;		/**< events popped */
+  unsigned long total;		/**< ticks, summed over events */
+  unsigned char max;		/**< ticks (saturates) */
+} P2swLatency;
+
+extern volatile unsigned int p2sw_now;	/**< ticks counted by p2sw_tick */
+extern P2swLatency p2swLatency;
+extern unsigned char p2swDropped; /**< events lost to a full ring */
+
+/** Call from the tick interrupt handler.
+ *  \return the switches that finished debouncing this tick
+ */
+unsigned char p2sw_tick();
+
+/** Call with interrupts off when p2sw_tick stops being called (e.g.
+ *  before sleeping with no tick source running).  Switches being
+ *  debounced are re-read and re-armed at once, and changes are not
+ *  debounced until p2sw_tick is called again.
+ */
+void p2sw_tickStop();
+
+/** Non-blocking: copy the oldest event to e.
+ *  \return 0 if there are no events
+ */
+int p2sw_pop(P2swEvent *e);
+
+int p2sw_pending();		/**< true if there are events to pop */
+
+/** True if no switch is being debounced: the tick is no longer
+ *  needed, so main may sleep in LPM3/LPM4 (which stop it)
+ */
+int p2sw_settled();
+
 #endif // included
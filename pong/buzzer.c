@@ -2,12 +2,23 @@
 #include "libTimer.h"
 #include "buzzer.h"
 
-static unsigned int period = 1000;
-static signed int rate = 200;	
-
 #define MIN_PERIOD 1000
 #define MAX_PERIOD 4000
 
+#define REST_PERIOD 2000	/**< timer runs silently to time rests */
+
+static const SoundEffect siren = {MIN_PERIOD, 200, 244, 0, 1};
+
+static const SoundEffect *queue[BUZZER_QUEUE];
+static volatile unsigned char head, tail; /**< written by main, by the timer (or buzzer_stop) */
+static volatile unsigned char running;	/**< Timer A0 interrupt enabled */
+
+/* effect being played (touched only by the timer interrupt) */
+static const SoundEffect *effect;
+static unsigned int period, elapsed;
+static signed int rate;
+static unsigned char ticksLeft, decayLeft, volumeShift;
+
 void buzzer_init()
 {
     /* 
@@ -26,15 +37,89 @@ void buzzer_init()
     
 }
 
-void buzzer_advance_frequency() 
+/** Drive the speaker for the current period and volume */
+static void buzzer_output()
+{
+  if (period) {
+    CCR0 = period;
+    CCR1 = period - (period >> volumeShift); /* high for period >> volumeShift */
+  } else {
+    CCR0 = REST_PERIOD;
+    CCR1 = 0xffff;		/* never reached: output stays low */
+  }
+}
+
+/** Once per tick, from the timer interrupt */
+static void buzzer_tick()
+{
+  if (effect && !--ticksLeft)
+    effect = 0;
+  if (!effect) {
+    if (head == tail) {		/* nothing queued: stop the timer */
+      CCR0 = 0;
+      TA0CCTL0 = 0;
+      running = 0;
+      return;
+    }
+    effect = queue[tail & (BUZZER_QUEUE - 1)];
+    tail++;
+    period = effect->period;
+    rate = effect->sweep;
+    ticksLeft = effect->ticks;
+    decayLeft = effect->decay;
+    volumeShift = 1;		/* half duty: loudest */
+  } else {
+    period += rate;
+    if (effect->bounce &&
+	((rate > 0 && (period > MAX_PERIOD)) || 
+	 (rate < 0 && (period < MIN_PERIOD)))) {
+      rate = -rate;
+      period += (rate << 1);
+    }
+    if (effect->decay && !--decayLeft) {
+      decayLeft = effect->decay;
+      if (volumeShift < 4)
+	volumeShift++;
+    }
+  }
+  buzzer_output();
+}
+
+int buzzer_play(const SoundEffect *e)
 {
-  period += rate;
-  if ((rate > 0 && (period > MAX_PERIOD)) || 
-      (rate < 0 && (period < MIN_PERIOD))) {
-    rate = -rate;
-    period += (rate << 1);
+  int sr;
+  if ((unsigned char)(head - tail) >= BUZZER_QUEUE)
+    return 0;
+  queue[head & (BUZZER_QUEUE - 1)] = e;
+  head++;
+  sr = get_sr();
+  and_sr(~8);			/* GIE off: the timer may be stopping */
+  if (!running) {		/* start the timer; its first tick plays e */
+    running = 1;
+    elapsed = SOUND_TICK_COUNTS;
+    CCR0 = REST_PERIOD;
+    CCR1 = 0xffff;
+    TA0CCTL0 = CCIE;
   }
-  buzzer_set_period(period);
+  set_sr(sr);
+  return 1;
+}
+
+void buzzer_stop()
+{
+  int sr = get_sr();
+  and_sr(~8);
+  tail = head;
+  effect = 0;
+  running = 0;
+  TA0CCTL0 = 0;
+  CCR0 = 0;
+  set_sr(sr);
+}
+
+void buzzer_advance_frequency() 
+{
+  buzzer_play(&siren);
 }
 
 void buzzer_set_period(short cycles)
@@ -43,8 +128,15 @@ void buzzer_set_period(short cycles)
   CCR1 = cycles >> 1;		/* one half cycle */
 }
 
-
-    
-    
-  
-
+/* Timer A0 CCR0: once per period of the tone, counting out ticks */
+void
+__interrupt_vec(TIMER0_A0_VECTOR) Buzzer_Timer()
+{
+  DUTY_ISR_ENTER();		/* not asleep while a tone plays */
+  elapsed += CCR0 + 1;
+  if (elapsed >= SOUND_TICK_COUNTS) {
+    elapsed -= SOUND_TICK_COUNTS;
+    buzzer_tick();
+  }
+  DUTY_ISR_EXIT();
+}
@@ -1,8 +1,36 @@
 #ifndef buzzer_included
 #define buzzer_included
 
+/** Sound effects
+ *
+ *  Effects are queued (in constant time) and played one after another
+ *  by Timer A0's own interrupt, so the game never waits for a sound.
+ *  Times are in ticks of about 4ms (8192 counts of Timer A at 2MHz).
+ */
+typedef struct {
+  unsigned int period;		/**< Timer A counts (2MHz) per cycle, 0 for a rest */
+  int sweep;			/**< added to period each tick */
+  unsigned char ticks;		/**< duration */
+  unsigned char decay;		/**< ticks per halving of volume, 0 to hold */
+  unsigned char bounce;		/**< sweep back and forth within MIN/MAX_PERIOD */
+} SoundEffect;
+
+#define BUZZER_QUEUE 4		/**< effects waiting (a power of 2) */
+#define SOUND_TICK_COUNTS 8192
+
 void buzzer_init();
+
+/** Queue effect (which must stay valid while it plays, e.g. const)
+ *  \return 0 if the queue was full
+ */
+int buzzer_play(const SoundEffect *effect);
+
+/** Silence the buzzer and discard queued effects */
+void buzzer_stop();
+
+/** Queue a one second siren sweeping between MIN and MAX_PERIOD */
 void buzzer_advance_frequency();
+
 void buzzer_set_period(short cycles);
 
 #endif // included
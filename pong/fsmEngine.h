@@ -0,0 +1,35 @@
+#ifndef fsmEngine_included
+#define fsmEngine_included
+
+/** Table-driven state machines (fsmEngine.s)
+ *
+ *  A machine is data in flash: for each state, a row with a cell per
+ *  event giving the next state and an action.  fsm_dispatch looks the
+ *  cell up through the row table (no multiply), stores the next state
+ *  and jumps to the action through the action table, in constant time.
+ */
+
+typedef struct Fsm_s Fsm;
+
+/** Called after the state changes; may dispatch further events */
+typedef void (*FsmAction)(Fsm *fsm, unsigned char event);
+
+typedef struct {
+  unsigned char next;		/**< state */
+  unsigned char action;		/**< index into actions, 0 for none */
+} FsmCell;
+
+typedef struct {
+  const FsmCell * const *rows;	/**< rows[state][event] */
+  const FsmAction *actions;	/**< actions[0] is unused */
+  unsigned char events;		/**< cells per row: larger events are ignored */
+} FsmTable;
+
+struct Fsm_s {
+  const FsmTable *table;
+  volatile unsigned char state;
+};
+
+void fsm_dispatch(Fsm *fsm, unsigned char event);
+
+#endif // included
@@ -0,0 +1,31 @@
+	.arch msp430g2553
+	.p2align 1,0
+	.text
+
+	;; table-driven state machines, see fsmEngine.h
+	;; Fsm:      0 table, 2 state
+	;; FsmTable: 0 rows, 2 actions, 4 events
+	;; FsmCell:  0 next, 1 action
+
+	;; void fsm_dispatch(Fsm *fsm (r12), unsigned char event (r13))
+	.global fsm_dispatch
+fsm_dispatch:
+	mov	@r12, r14	; r14 = fsm->table
+	cmp.b	4(r14), r13	; event >= table->events?
+	jhs	fsm_none	;   then ignore it
+	mov.b	2(r12), r15	; r15 = fsm->state
+	rla	r15		; 2 bytes per row pointer
+	add	@r14, r15	; r15 = &rows[state]
+	mov	@r15, r15	; r15 = rows[state]
+	mov.b	r13, r11	; 2 bytes per cell
+	rla	r11
+	add	r11, r15	; r15 = &rows[state][event]
+	mov.b	@r15+, 2(r12)	; fsm->state = cell->next
+	mov.b	@r15, r15	; r15 = cell->action
+	tst	r15
+	jz	fsm_none
+	rla	r15		; 2 bytes per action
+	add	2(r14), r15	; r15 = &actions[action]
+	br	@r15		; tail call actions[action](fsm, event)
+fsm_none:
+	ret
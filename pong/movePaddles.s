@@ -16,68 +16,42 @@ BIT2:   .byte   0x04 ; define BIT2
         .global BIT3 
 BIT3:   .byte   0x08 ; define BIT3
 
-.data
+        .text
         .balign 2
         .global movePaddles
-        .extern p2sw_read ;
 
-        .extern fieldFence
-        .extern ml_plU
-        .extern ml_prU
-        .extern ml_plD
-        .extern ml_prD
+        .extern switchesActive
+        .extern ml_pl
+        .extern ml_pr
 
-        .extern layerPl
-        .extern layerPr
+        ;; MovLayer: 0 layer, 2 velocity.axes[0], 4 velocity.axes[1], 6 next
+        .equ    VELOCITY_Y, 4
+        .equ    PADDLE_SPEED, 5*256 ; pixels per step, 8.8 fixed point
 
-        .word   movePaddles
+;;; Decodes the switches, read once, into each paddle's net velocity:
+;;; sw1/sw2 move the left paddle up/down, sw3/sw4 the right.
+;;; Both switches of a pair cancel.  Drawing happens later, in one pass.
 movePaddles:
-        sub     #6, R1      ; make space for sp and r12
-        mov     R12, 0(R1) ; save r12 
-        mov     R13, 2(R1) ; save r13 
-
-        CALL    #p2sw_read ; sw = p2sw_read results
-        mov     R12, 4(R1) ; sw => 4(R1)
-        
-if_0:   and.b   &BIT0, &P2IN ; if( ~(BIT0 & sw))  => condition satisfied when BITO & sw are 0
-        jnz     fi_0
-        mov     #ml_plU, R12  ; movLayerDraw(&ml_plU, &layerPl)
-        mov     #layerPl, R13
-        CALL    #movLayerDraw 
-        mov     #ml_plU, R12  ; mlPaddleAdvance(&ml_plU, &fieldFence)
-        mov     #fieldFence, R13
-        CALL    #mlPaddleAdvance
-
-fi_0:   
-if_1:   and.b   &BIT1, &P2IN  ; if (BIT1 ...
-        jnz     fi_1
-        mov     #ml_plD, R12  ; movLayerDraw(&ml_plD, &layerPl)
-        mov     #layerPl, R13
-        CALL    #movLayerDraw  
-        mov     #ml_plD, R12  ; mlPaddleAdvance(&ml_plD, &fieldFence)
-        mov     #fieldFence, R13
-        CALL    #mlPaddleAdvance
-fi_1:
-if_2:   and.b   &BIT2, &P2IN     ; if (BIT2 ...
-        jnz     fi_2
-        mov     #ml_prU, R12  ; movLayerDraw(&ml_prU, &layerPr)
-        mov     #layerPr, R13
-        CALL    #movLayerDraw  
-        mov     #ml_prU, R12  ; mlPaddleAdvance(&ml_prU, &fieldFence)
-        mov     #fieldFence, R13
-        CALL    #mlPaddleAdvance
+        mov.b   &switchesActive, R12 ; sw = switchesActive
+
+        clr     R13             ; left velocity = 0
+if_0:   bit.b   &BIT0, R12      ; if (BIT0 & sw) => up
+        jz      fi_0
+        sub     #PADDLE_SPEED, R13
+fi_0:
+if_1:   bit.b   &BIT1, R12      ; if (BIT1 & sw) => down
+        jz      fi_1
+        add     #PADDLE_SPEED, R13
+fi_1:   mov     R13, &ml_pl+VELOCITY_Y
+
+        clr     R13             ; right velocity = 0
+if_2:   bit.b   &BIT2, R12      ; if (BIT2 & sw) => up
+        jz      fi_2
+        sub     #PADDLE_SPEED, R13
 fi_2:
-if_3:   and.b   &BIT3, &P2IN
-        jnz     fi_3
-        mov     #ml_prD, R12  ; movLayerDraw(&ml_prD, &layerPr)
-        mov     #layerPr, R13
-        CALL    #movLayerDraw  
-        mov     #ml_prD, R12  ; mlPaddleAdvance(&ml_prD, &fieldFence)
-        mov     #fieldFence, R13
-        CALL    #mlPaddleAdvance
+if_3:   bit.b   &BIT3, R12      ; if (BIT3 & sw) => down
+        jz      fi_3
+        add     #PADDLE_SPEED, R13
+fi_3:   mov     R13, &ml_pr+VELOCITY_Y
 
-fi_3:
-out:    mov     0(R1), R12  ; clean up
-        mov     2(R1), R13  ; clean up
-        add     #6, R1      ; restore sp
-        ret
+out:    ret
@@ -10,38 +10,63 @@
 #include <libTimer.h>
 #include <lcdutils.h>
 #include <lcddraw.h>
+#include <lcdformat.h>
 #include <p2switches.h>
 #include <shape.h>
 #include <abCircle.h>
+#include <hud.h>
 #include "pong.h"
 #include "buzzer.h"
 #include "stateMachines.h"
 #include "movePaddles.h"
 
-#define GREEN_LED BIT6
-
-#define MAX_SCORE 5
-
-#define DELAY 500000
+#define MAX_SCORE 0x5            /**< BCD, like the scores */
+
+#define STEP_SHIFT 4
+#define STEP_TICKS (1 << STEP_SHIFT) /**< simulation steps about 15 times/sec */
+#define MAX_STEPS 4             /**< steps per frame before time is dropped */
+#define FRAME_TICKS 8           /**< frames render about 30 times/sec */
+#define FRAME_BUDGET_US 20000   /**< render time per frame */
+
+#ifndef PONG_BALLS
+#define PONG_BALLS 1            /**< build with -DPONG_BALLS=n for more */
+#endif
+/* each ball: an 18 byte Layer, a 10 byte MovLayer, 8 bytes of interpolation;
+ * static RAM is about 307 bytes with one ball, 70 more with the profiler
+ * or duty meter, and the stack needs about 150 of the 512 */
+#if defined(PROFILE) && defined(DUTY)
+#error "PROFILE and DUTY don't fit in RAM together: build with one"
+#elif defined(PROFILE) || defined(DUTY)
+#define PONG_BALLS_MAX 1
+#else
+#define PONG_BALLS_MAX 2
+#endif
+#if PONG_BALLS < 1 || PONG_BALLS > PONG_BALLS_MAX
+#error "PONG_BALLS: too many balls for RAM (each takes 36 bytes)"
+#endif
 
 /* Sounds for collisions */
 #define L_P_PERIOD 3500
 #define L_F_PERIOD 1000
 #define R_P_PERIOD 4000
 #define R_F_PERIOD 1500
+#define HIT_TICKS 8             /**< about 31ms, as long as the old busy wait */
 
-static int pl_score = 0;
-static char pl_score_string[1];
-static int pr_score = 0;
-static char pr_score_string[1];
-static char winner[] = "player 2";
+static const SoundEffect leftPaddleSound  = { L_P_PERIOD, 0, HIT_TICKS, 0, 0 };
+static const SoundEffect leftFenceSound   = { L_F_PERIOD, 0, HIT_TICKS, 0, 0 };
+static const SoundEffect rightPaddleSound = { R_P_PERIOD, 0, HIT_TICKS, 0, 0 };
+static const SoundEffect rightFenceSound  = { R_F_PERIOD, 0, HIT_TICKS, 0, 0 };
 
-AbRect ball    = {abRectGetBounds, abRectCheck, {4,4}}; /**< 10x10 rectangle */
-AbRect paddle2 = {abRectGetBounds, abRectCheck, {4,14}}; /**< 10x10 rectangle */
-AbRect paddle1 = {abRectGetBounds, abRectCheck, {4,14}}; /**< 10x10 rectangle */
-AbRArrow rightArrow = {abRArrowGetBounds, abRArrowCheck, 30};
+static BcdCounter pl_score = 0;  /**< shown without dividing by 10 */
+static BcdCounter pr_score = 0;
+static const char *winner = "player 2";
 
-AbRectOutline fieldOutline = {	/* playing field */
+/* shapes never change: const keeps them in flash */
+const AbRect ball    = {abRectGetBounds, abRectCheck, {4,4}}; /**< 10x10 rectangle */
+const AbRect paddle2 = {abRectGetBounds, abRectCheck, {4,14}}; /**< 10x10 rectangle */
+const AbRect paddle1 = {abRectGetBounds, abRectCheck, {4,14}}; /**< 10x10 rectangle */
+
+const AbRectOutline fieldOutline = {	/* playing field */
   abRectOutlineGetBounds, abRectOutlineCheck,   
   {screenWidth/2 - 10, screenHeight/2 - 10}
 };
@@ -73,107 +98,62 @@ Layer layerPl = {		/**< Layer with left paddle1*/
   &layerPr,
 };
 
-Layer layerBall = {		/**< Layer with the ball */
-  (AbShape *)&ball,
-  {(screenWidth/2)+10, (screenHeight/2)+5}, /**< bit below & right of center */
-  {0,0}, {0,0},				    /* last & next pos */
-  COLOR_WHITE,
-  &layerPl,
-};
-
-/** Moving Layer
- *  Linked list of layer references
- *  Velocity represents one iteration of change (direction & magnitude)
- */
-typedef struct MovLayer_s {
-  Layer *layer;
-  Vec2 velocity;
-  struct MovLayer_s *next;
-} MovLayer;
+/* paddle mov layers: velocities are set from the switches each step */
+MovLayer ml_pr = { &layerPr, {0,0}, 0 }; 
+MovLayer ml_pl = { &layerPl, {0,0}, &ml_pr }; 
 
-/* initial value of {0,0} will be overwritten */
-MovLayer ml_ball = { &layerBall, {4,4}, 0 }; 
+/* balls, chained ahead of the paddles (ballsInit), so that
+ * ballLayers and ballMovers head the lists of all layers and movers */
+Layer ballLayers[PONG_BALLS];
+MovLayer ballMovers[PONG_BALLS];
 
-/* paddle mov layers */
-MovLayer ml_plU = { &layerPl, {0,-5}, 0 }; 
-MovLayer ml_plD = { &layerPl, {0,5}, 0 }; 
+#define isBall(l) ((l) >= ballLayers && (l) < ballLayers + PONG_BALLS)
 
-MovLayer ml_prU = { &layerPr, {0,-5}, 0 }; 
-MovLayer ml_prD = { &layerPr, {0,5}, 0 }; 
+/* hourglass: lit while the frame governor is skipping HUD frames */
+static const u_char slowIcon[] = { 0xff, 0x42, 0x24, 0x18, 0x18, 0x24, 0x5a, 0xff };
 
-void movLayerDraw(MovLayer *movLayers, Layer *layers)
-{
-  int row, col;
-  MovLayer *movLayer;
-
-  and_sr(~8);			/**< disable interrupts (GIE off) */
-  for (movLayer = movLayers; movLayer; movLayer = movLayer->next) { /* for each moving layer */
-    Layer *l = movLayer->layer;
-    l->posLast = l->pos;
-    l->pos = l->posNext;
-  }
-  or_sr(8);			/**< disable interrupts (GIE on) */
-
-
-  for (movLayer = movLayers; movLayer; movLayer = movLayer->next) { /* for each moving layer */
-    Region bounds;
-    layerGetBounds(movLayer->layer, &bounds);
-    lcd_setArea(bounds.topLeft.axes[0], bounds.topLeft.axes[1], 
-		bounds.botRight.axes[0], bounds.botRight.axes[1]);
-    for (row = bounds.topLeft.axes[1]; row <= bounds.botRight.axes[1]; row++) {
-      for (col = bounds.topLeft.axes[0]; col <= bounds.botRight.axes[0]; col++) {
-	Vec2 pixelPos = {col, row};
-	u_int color = bgColor;
-	Layer *probeLayer;
-	for (probeLayer = layers; probeLayer; 
-	     probeLayer = probeLayer->next) { /* probe all layers, in order */
-	  if (abShapeCheck(probeLayer->abShape, &probeLayer->pos, &pixelPos)) {
-	    color = probeLayer->color;
-	    break; 
-	  } /* if probe check */
-	} // for checking all layers at col, row
-	lcd_writeColor(color); 
-      } // for col
-    } // for row
-  } // for moving layer being updated
-}	  
+/* the HUD: drawn only when a score or the governor's level changes */
+static HudState hudState[3];
+static const HudWidget hudSlow = {
+  HUD_ICON, screenWidth/2 - 4, 1, 8, COLOR_RED, COLOR_BLACK, &govLevel, slowIcon,
+  &hudState[0], 0
+};
+static const HudWidget hudPr = {
+  HUD_BCD, screenWidth-26, 1, 2, COLOR_YELLOW, COLOR_BLACK, &pr_score, 0,
+  &hudState[1], &hudSlow
+};
+static const HudWidget hudPl = {
+  HUD_BCD, 14, 1, 2, COLOR_YELLOW, COLOR_BLACK, &pl_score, 0,
+  &hudState[2], &hudPr
+};
 
 
-/*
- * Draws the score on the playing screen
- */
-void
-scoreDraw()
-{
-    /* left */
-    getScoreChar(pl_score, pl_score_string);
-    drawChar5x7(20, 1, pl_score_string[0], COLOR_YELLOW, COLOR_BLACK);
-    /* right */
-    getScoreChar(pr_score, pr_score_string);
-    drawChar5x7(screenWidth-20, 1, pr_score_string[0], COLOR_YELLOW, COLOR_BLACK);
-}
-
-/*
- * sets s to char representation of n
- * from k&r itoa
+/**
+ * Lines the balls up below & right of center, 12 pixels apart,
+ * heading off in all four diagonal directions, and links them
+ * ahead of the paddles
  */
 void
-getScoreChar(int n, char s[])
+ballsInit()
 {
-   int i, sign;
-
-   if ((sign = n) <0) /* record sign */
-       n = -n;
-   i=0;
-   do{
-       s[i++] = n % 10 + '0';
-   } while ((n /= 10) >0);
-   if (sign < 0)
-       s[i++] = '-';
-   s[i] = '\0';
+    u_char i;
+    for (i = 0; i < PONG_BALLS; i++) {
+        Layer *l = &ballLayers[i];
+        MovLayer *ml = &ballMovers[i];
+        l->abShape = (AbShape *)&ball;
+        l->pos.axes[0] = screenWidth/2 + 10 - (i & 3) * 12;
+        l->pos.axes[1] = screenHeight/2 + 5 - (i >> 2) * 12;
+        l->color = COLOR_WHITE;
+        l->next = i + 1 < PONG_BALLS ? l + 1 : &layerPl;
+        ml->layer = l;
+        ml->velocity.axes[0] = (i & 1) ? -FIX(4) : FIX(4);
+        ml->velocity.axes[1] = FIX(4) - (i << 5); /**< each 1/8 pixel slower */
+        if (i & 2)
+            ml->velocity.axes[1] = -ml->velocity.axes[1];
+        ml->next = i + 1 < PONG_BALLS ? ml + 1 : &ml_pl;
+    }
 }
 
-
 /** Advances the paddle within a fence
  *  
  *  \param ml The moving shape to be advanced
@@ -182,20 +162,20 @@ getScoreChar(int n, char s[])
 void
 mlPaddleAdvance(MovLayer *ml, Region *fence)
 {
-    Vec2 newPos;
+    Vec2 newPos, move;
     u_char axis;
     Region shapeBoundary;
     for (; ml; ml = ml->next) 
     {
-        vec2Add(&newPos, &ml->layer->posNext, &ml->velocity);
+        movLayerStep(ml, &move);
+        vec2Add(&newPos, &ml->layer->posNext, &move);
         abShapeGetBounds(ml->layer->abShape, &newPos, &shapeBoundary);
         for (axis = 0; axis < 2; axis ++) 
         {
             if ((shapeBoundary.topLeft.axes[axis] < fence->topLeft.axes[axis]) ||
                     (shapeBoundary.botRight.axes[axis] > fence->botRight.axes[axis]) ) 
             { 
-                int velocity = REV * (ml->velocity.axes[axis]);
-                newPos.axes[axis] += (velocity);   /*< don't bounce, just don't move past bound*/ 
+                newPos.axes[axis] -= move.axes[axis];   /*< don't bounce, just don't move past bound*/ 
             }	/**< if outside of fence */
         } /**< for axis */
         ml->layer->posNext = newPos;
@@ -203,147 +183,111 @@ mlPaddleAdvance(MovLayer *ml, Region *fence)
 
 }
 
-/** Advances the ball within a fence
+#define MAX_BOUNCES 2           /**< contacts handled per step */
+
+/** Advances the balls within a fence
+ *
+ *  Collisions are swept along each ball's velocity, so a fast ball can't
+ *  pass through a paddle between steps: the ball moves to the earliest
+ *  contact, bounces (scoring or sounding there), then travels the rest
+ *  of the step.
  *  
- *  \param ml The moving shape to be advanced
- *  \param fence The region which will serve as a boundary for ml
+ *  \param balls The balls to be advanced, up to paddles
+ *  \param paddles The paddles (to the end of the list), at their next positions
+ *  \param fence The region which will serve as a boundary for the balls
  */
-void mlBallAdvance(MovLayer *ml_ball, MovLayer *ml_plU, MovLayer *ml_prU, Region *fence)
+void mlBallAdvance(MovLayer *balls, MovLayer *paddles, Region *fence)
 {
-    Vec2 newPos_ball;
-    Vec2 newPos_pl;
-    Vec2 newPos_pr;
-
-    u_char axis;
-
-    Region ballBoundary;
-    Region plBoundary;
-    Region prBoundary;
-
-    for (; ml_ball; ml_ball = ml_ball->next) {
-        vec2Add(&newPos_ball, &ml_ball->layer->posNext, &ml_ball->velocity);
-        abShapeGetBounds(ml_ball->layer->abShape, &newPos_ball, &ballBoundary);
-
-        vec2Add(&newPos_pl, &ml_plU->layer->posNext, &ml_plU->velocity);
-        abShapeGetBounds(ml_plU->layer->abShape, &newPos_pl, &plBoundary);           /** get left paddle boundaries */
-
-        vec2Add(&newPos_pr, &ml_prU->layer->posNext, &ml_prU->velocity);
-        abShapeGetBounds(ml_prU->layer->abShape, &newPos_pr, &prBoundary);           /** get left paddle boundaries */
-        for (axis = 0; axis < 2; axis ++) 
-        {
-            /** left_fence should act as a bool here. If we go into the inner section of this if, then it hit some part of the fence */
-            if ( (ballBoundary.topLeft.axes[axis] < fence->topLeft.axes[axis])) 
-            {
-                if (axis == 0)         /**< only care about left/right wall*/
-                {
-                    //if win
-		    if (++pr_score == MAX_SCORE)
-		    {
-			/* draw pr winner */
-			winner[7] = '2';
-                        winscreen();
-			int velocity = ml_ball->velocity.axes[axis] =  -ml_ball->velocity.axes[axis];
-			newPos_ball.axes[axis] += (2*velocity);
-			break;
-		    }
-
-                    buzzer_set_period(L_F_PERIOD);
-                    __delay_cycles(DELAY); //leave the buzzer on
+    MovLayer *ml, *p, *paddleHit;
+    Vec2 pos, move, part;
+    Region ballBoundary, paddleBoundary;
+    SweepHit hit, contact;
+    u_char bounces;
+
+    for (ml = balls; ml != paddles; ml = ml->next) {
+        Layer *l = ml->layer;
+        pos = l->posNext;               /**< where the ball is */
+        movLayerStep(ml, &move);        /**< and how far it still goes this step */
+        for (bounces = 0; bounces < MAX_BOUNCES; bounces++) {
+            u_char fenceHit;
+            abShapeGetBounds(l->abShape, &pos, &ballBoundary);
+            fenceHit = sweepFence(&ballBoundary, &move, fence, &hit);
+            paddleHit = 0;              /**< earliest contact wins */
+            for (p = paddles; p; p = p->next) {
+                abShapeGetBounds(p->layer->abShape, &p->layer->posNext, &paddleBoundary);
+                if (sweepRegion(&ballBoundary, &move, &paddleBoundary, &contact) &&
+                    (!(fenceHit || paddleHit) || contact.time < hit.time)) {
+                    hit = contact;
+                    paddleHit = p;
                 }
-                int velocity = ml_ball->velocity.axes[axis] =  -ml_ball->velocity.axes[axis];
-                newPos_ball.axes[axis] += (2*velocity);
             }
-            if(ballBoundary.botRight.axes[axis] > fence->botRight.axes[axis])  
-            {
-                if (axis == 0) 
-                {
+            if (!fenceHit && !paddleHit)
+                break;
+
+            sweepPartial(&part, &move, hit.time);
+            vec2Add(&pos, &pos, &part); /**< to the point of contact */
+            vec2Sub(&move, &move, &part);
+            move.axes[hit.axis] = -move.axes[hit.axis]; /**< bounce the rest of the step */
+            ml->velocity.axes[hit.axis] = -ml->velocity.axes[hit.axis];
+
+            if (paddleHit)
+                buzzer_play(paddleHit->layer->posNext.axes[0] < screenWidth/2 ?
+                            &leftPaddleSound : &rightPaddleSound);
+            else if (hit.axis == 0) {   /**< only care about left/right wall*/
+                if (ml->velocity.axes[0] > 0) { /**< was heading left */
+                    //if win
+                    bcdIncrement(&pr_score);
+                    if (pr_score == MAX_SCORE) {
+                        /* draw pr winner */
+                        winner = "player 2";
+                        fsm_dispatch(&sceneFsm, SCENE_EV_WON); /**< to the win scene */
+                        return;
+                    }
+                    buzzer_play(&leftFenceSound);
+                } else {
                     //do thing for right side score.
-		    if (++pl_score == MAX_SCORE)
-		    {
-			/* draw pr winner */
-			winner[7] = '1';
-                        winscreen();
-			int velocity = ml_ball->velocity.axes[axis] =  -ml_ball->velocity.axes[axis];
-			newPos_ball.axes[axis] += (2*velocity);
-			break;
-		    }
-                    buzzer_set_period(R_F_PERIOD);
-                    __delay_cycles(DELAY); //leave the buzzer on
+                    bcdIncrement(&pl_score);
+                    if (pl_score == MAX_SCORE) {
+                        /* draw pl winner */
+                        winner = "player 1";
+                        fsm_dispatch(&sceneFsm, SCENE_EV_WON); /**< to the win scene */
+                        return;
+                    }
+                    buzzer_play(&rightFenceSound);
                 }
-                int velocity = ml_ball->velocity.axes[axis] =  -ml_ball->velocity.axes[axis];
-                newPos_ball.axes[axis] += (2*velocity);
-            }	//**< if outside of fence 
-
-
-            
-            
-            //**< left paddle, check right side  
-            else if (
-                    (ballBoundary.topLeft.axes[0] < plBoundary.botRight.axes[0]) && //hitting the side of paddle
-                    (   //*ball top y val < left paddle top */    /*ball top y val  > left paddle bottom */ //top of ball between y valls of paddle 
-                        (ballBoundary.topLeft.axes[1] > plBoundary.topLeft.axes[1] && ballBoundary.topLeft.axes[1] < plBoundary.botRight.axes[1]) ||
-                        //*ball bottom y val < left paddle top */   /*ball bottom y val  > left paddle bottom */  
-                        (ballBoundary.botRight.axes[1] > plBoundary.topLeft.axes[1] && ballBoundary.botRight.axes[1] < plBoundary.botRight.axes[1])  
-                    ) 
-               )
-            {
-                // do a thing for left side paddle collision
-                buzzer_set_period(L_P_PERIOD);
-                __delay_cycles(DELAY); //leave the buzzer on
-                int velocity = ml_ball->velocity.axes[axis] =  -ml_ball->velocity.axes[axis];
-                newPos_ball.axes[axis] += (2*velocity);
-                break;
             }
-                        
-            //**< right paddle, check left side 
-            else if (
-                    (ballBoundary.botRight.axes[0] > prBoundary.topLeft.axes[0]) && //hitting the side of paddle
-                    (   //*ball top y val < right paddle top */    /*ball top y val  > right paddle bottom */ //top of ball between y valls of paddle 
-                        (ballBoundary.topLeft.axes[1] > prBoundary.topLeft.axes[1] && ballBoundary.topLeft.axes[1] < prBoundary.botRight.axes[1]) ||
-                        //*ball bottom y val < right paddle top */   /*ball bottom y val  > right paddle bottom */  
-                        (ballBoundary.botRight.axes[1] > prBoundary.topLeft.axes[1] && ballBoundary.botRight.axes[1] < prBoundary.botRight.axes[1])  
-                    ) 
-               )
-            {
-                // do a thing for left side paddle collision
-                buzzer_set_period(R_P_PERIOD);
-                __delay_cycles(DELAY); //leave the buzzer on
-                int velocity = ml_ball->velocity.axes[axis] =  -ml_ball->velocity.axes[axis];
-                newPos_ball.axes[axis] += (2*velocity);
-                break;
-            }
-	   
-        } /**< for axis */
-        ml_ball->layer->posNext = newPos_ball;
-    } /**< for ml_ball */
+        }
+        vec2Add(&pos, &pos, &move);
+        l->posNext = pos;
+    }
 }
 
 
 Region fieldFence;		/**< fence around playing field  */
 
+u_char switchesDown;            /**< switches held, from p2sw events */
+u_char switchesActive;          /**< held now or pressed since the last poll */
+
 /**
- * Reads switch inputs and move's paddles accordingly
+ * Applies queued switch events: a press shorter than a frame still
+ * shows in switchesActive until the next poll.
+ * Returns the number of events applied
  */
-void
-movePaddlesC(){
-    unsigned int sw = p2sw_read();
-    if(!(BIT0 & sw)){
-        movLayerDraw(&ml_plU, &layerPl);  /** So, of course you have to draw the layer before you can advance the screen */
-        mlPaddleAdvance(&ml_plU, &fieldFence);
-    }
-    if(!(BIT1 & sw)){
-        movLayerDraw(&ml_plD, &layerPl);  
-        mlPaddleAdvance(&ml_plD, &fieldFence);
-    }
-    if(!(BIT2 & sw)){
-        movLayerDraw(&ml_prU, &layerPl);  
-        mlPaddleAdvance(&ml_prU, &fieldFence);
-    }
-    if(!(BIT3 & sw)){
-        movLayerDraw(&ml_prD, &layerPl);  
-        mlPaddleAdvance(&ml_prD, &fieldFence);
+int
+pollSwitchEvents()
+{
+    P2swEvent e;
+    int events = 0;
+    switchesActive = switchesDown;
+    while (p2sw_pop(&e)) {
+        events++;
+        if (e.down) {
+            switchesDown |= e.sw;
+            switchesActive |= e.sw;
+        } else
+            switchesDown &= ~e.sw;
     }
-    
+    return events;
 }
 
 /**
@@ -356,37 +300,78 @@ startscreen()
     drawString5x7(screenWidth/2 -10 , 25, "PONG", COLOR_BLACK, COLOR_BLUE);
     drawString5x7(20, 35, "Press any button", COLOR_BLACK, COLOR_BLUE);
     //drawString5x7(5, 35, "Press any button to start", COLOR_BLACK, COLOR_BLUE);
-    for(;;)
-    {
-	
-	if(!(BIT0 & P2IN)){
-	    ml_ball.velocity.axes[0] = 4;
-	    ml_ball.velocity.axes[0] = 4;
-	    //state_advance();
-	    break;
-	}
-	if(!(BIT1 & P2IN)){
-	    ml_ball.velocity.axes[0] = 4;
-	    ml_ball.velocity.axes[0] = 4;
-	    //state_advance();
-	    break;
-	}
-	if(!(BIT2 & P2IN)){
-	    ml_ball.velocity.axes[0] = 4;
-	    ml_ball.velocity.axes[0] = 4;
-	    //state_advance();
-	    break;
-	}
-	if(!(BIT3 & P2IN)){
-	    ml_ball.velocity.axes[0] = 4;
-	    ml_ball.velocity.axes[0] = 4;
-	    //state_advance();
-	    break;
-    	} 
-    }
+    ballsInit();
     //maybe color screen black again?
 }
 
+#ifdef PROFILE
+/** Profiler zones */
+enum { ZONE_BALL, ZONE_DRAW, ZONE_SCORE, ZONE_PADDLES, ZONE_SPI = SHAPE_PROF_SPI };
+static const char * const zoneNames[] = { "balls", "draw", "score", "paddles", "spi" };
+
+/*
+ * Draws one profiler zone: name and count, then min, max and
+ * per-frame cpu cycles (hex).  The ball and paddle zones are the
+ * simulation's compute; the draw zone is composing plus the spi
+ * bursts, which shapeLib (built with -DPROFILE) times on their own
+ * in the spi zone.
+ */
+static void
+profZoneDraw(u_char zone, const ProfZone *z)
+{
+    u_char row = 55 + zone * 17;
+    unsigned int frames = profZones[ZONE_DRAW].count;
+    char s[8];
+    drawString5x7(5, row, (char *)zoneNames[zone], COLOR_BLACK, COLOR_BLUE);
+    fmtHex(s, z->count, 4);
+    drawString5x7(60, row, s, COLOR_BLACK, COLOR_BLUE);
+    fmtHex(s, PROF_CYCLES(z->min), 6);
+    drawString5x7(5, row + 9, s, COLOR_BLACK, COLOR_BLUE);
+    fmtHex(s, PROF_CYCLES(z->max), 6);
+    drawString5x7(45, row + 9, s, COLOR_BLACK, COLOR_BLUE);
+    fmtHex(s, PROF_CYCLES(frames ? z->total / frames : 0), 6); /**< once a game */
+    drawString5x7(85, row + 9, s, COLOR_BLACK, COLOR_BLUE);
+}
+
+/*
+ * Draws the frame governor's overrun count (hex) and level
+ */
+static void
+govDraw()
+{
+    char s[5];
+    drawString5x7(5, 150, "over", COLOR_BLACK, COLOR_BLUE);
+    fmtHex(s, govStats.overruns, 4);
+    drawString5x7(35, 150, s, COLOR_BLACK, COLOR_BLUE);
+    fmtHex(s, govLevel, 1);
+    drawString5x7(70, 150, "lv", COLOR_BLACK, COLOR_BLUE);
+    drawString5x7(85, 150, s, COLOR_BLACK, COLOR_BLUE);
+}
+#endif
+
+#ifdef DUTY
+/*
+ * Draws the cpu busy percentage over recent frames and the
+ * energy of the last frame (nJ, hex)
+ */
+static void
+dutyDraw()
+{
+    char s[9];
+    u_char busy = duty_busyPercent();
+    if (busy > 99)
+        busy = 99;
+    fmtUnsigned(s, busy, 2, FMT_ZERO_PAD);
+    s[2] = '%';
+    s[3] = '\0';
+    drawString5x7(5, 140, "busy", COLOR_BLACK, COLOR_BLUE);
+    drawString5x7(35, 140, s, COLOR_BLACK, COLOR_BLUE);
+    fmtHex(s, dutyLastFrame.energy, 6);
+    drawString5x7(60, 140, s, COLOR_BLACK, COLOR_BLUE);
+    drawString5x7(100, 140, "nJ", COLOR_BLACK, COLOR_BLUE);
+}
+#endif
+
 /**
  * Draw win screen
  * Shows winning player's name
@@ -397,19 +382,205 @@ winscreen()
     clearScreen(COLOR_BLUE);
     drawString5x7(screenWidth/2 -10 , 25, "PONG", COLOR_BLACK, COLOR_BLUE);
     drawString5x7(20, 35, "The winner is:", COLOR_BLACK, COLOR_BLUE);
-    drawString5x7(20, 45, winner, COLOR_BLACK, COLOR_BLUE);
-    for(;;){	
-	if(!(( BIT0 | BIT1 ) & P2IN)){
-	    pl_score = pr_score = 0;
-	    break;
-	}
-    }
+    drawString5x7(20, 45, (char *)winner, COLOR_BLACK, COLOR_BLUE);
+#ifdef PROFILE
+    prof_dump(profZoneDraw);  /**< cycles spent per frame in each zone */
+    govDraw();
+#endif
+#ifdef DUTY
+    dutyDraw();               /**< cpu busy and energy per frame */
+#endif
+}
+
+/**
+ * Start another game: scores, statistics and the playing field
+ */
+void
+newgame()
+{
+    pl_score = pr_score = 0;
+    gov_init(FRAME_BUDGET_US);
+#ifdef DUTY
+    duty_reset();
+#endif
     clearScreen(COLOR_BLACK); /* clear screen and redraw shapes */
-    layerDraw(&layerBall);
-    scoreDraw();
+    layerDraw(ballLayers);
+    hudInvalidate(&hudPl, 0);
+    hudDraw(&hudPl);
+#ifdef PROFILE
+    prof_reset();             /**< profile the next game's frames afresh */
+#endif
 }
 u_int bgColor = COLOR_BLACK;     /**< The background color */
-int redrawScreen = 1;           /**< Boolean for whether screen needs to be redrawn */
+int redrawScreen = 1;           /**< Boolean for whether screen needs to be redrawn (set when a timer is due) */
+
+
+static Vec2 ballFrom[PONG_BALLS], ballTo[PONG_BALLS]; /**< positions before and after the last step */
+static unsigned int simLast;    /**< sched_now when the simulation last caught up */
+static unsigned int simAccum;   /**< ticks not yet simulated */
+unsigned int simDropped;        /**< frames that fell more than MAX_STEPS behind */
+
+/** Two overlapping balls that are closing on the axis they overlap
+ *  least on swap their velocities on it (equal masses, elastic) */
+static void
+ballsBounce(Layer *a, Layer *b)
+{
+  Region ra, rb;
+  int *va = ballMovers[a - ballLayers].velocity.axes;
+  int *vb = ballMovers[b - ballLayers].velocity.axes;
+  int depth[2], rel, gap, t;
+  u_char axis;
+  abShapeGetBounds(a->abShape, &a->posNext, &ra);
+  abShapeGetBounds(b->abShape, &b->posNext, &rb);
+  for (axis = 0; axis < 2; axis++) {
+    int lo = ra.topLeft.axes[axis] > rb.topLeft.axes[axis] ?
+      ra.topLeft.axes[axis] : rb.topLeft.axes[axis];
+    int hi = ra.botRight.axes[axis] < rb.botRight.axes[axis] ?
+      ra.botRight.axes[axis] : rb.botRight.axes[axis];
+    depth[axis] = hi - lo;
+  }
+  axis = depth[1] < depth[0];
+  rel = vb[axis] - va[axis];
+  gap = a->posNext.axes[axis] - b->posNext.axes[axis];
+  if (!rel || !gap || (rel < 0) != (gap < 0))
+    return;                     /**< already parting (no multiply needed) */
+  t = va[axis];
+  va[axis] = vb[axis];
+  vb[axis] = t;
+}
+
+/** Contact callback: balls bounce off each other, and a ball still
+ *  heading into a paddle that it overlaps (the paddle moved onto it,
+ *  so no sweep saw it coming) is put beside the paddle and bounced */
+static void
+ballContact(Layer *a, Layer *b, const Vec2 *contact, void *unused)
+{
+  Region ballBounds, paddleBounds;
+  int *vx;
+  if (!isBall(a))
+    return;                     /**< two paddles: balls come first in the list */
+  if (isBall(b)) {
+    ballsBounce(a, b);
+    return;
+  }
+  vx = &ballMovers[a - ballLayers].velocity.axes[0];
+  abShapeGetBounds(a->abShape, &a->posNext, &ballBounds);
+  abShapeGetBounds(b->abShape, &b->posNext, &paddleBounds);
+  if (b == &layerPl && *vx < 0) {
+    a->posNext.axes[0] += paddleBounds.botRight.axes[0] + 1 - ballBounds.topLeft.axes[0];
+    *vx = -*vx;
+    buzzer_play(&leftPaddleSound);
+  } else if (b == &layerPr && *vx > 0) {
+    a->posNext.axes[0] += paddleBounds.topLeft.axes[0] - 1 - ballBounds.botRight.axes[0];
+    *vx = -*vx;
+    buzzer_play(&rightPaddleSound);
+  }
+}
+
+/** One fixed simulation step: input, paddles, then the balls.
+ *  Main only: it pops the switch events, which only main consumes,
+ *  and a win dispatches to the win scene, which draws. */
+static void
+simStep()
+{
+  u_char i;
+  MOVLAYER_WRITE_BEGIN();       /**< posNext writer; main alone draws (shape.h) */
+  for (i = 0; i < PONG_BALLS; i++) {
+    ballLayers[i].posNext = ballTo[i]; /**< undo the interpolation */
+    ballFrom[i] = ballTo[i];
+  }
+  PROF_BEGIN(ZONE_PADDLES);
+  pollSwitchEvents();           /**< input is sampled once per step */
+  movePaddles();                /**< switches => paddle velocities */
+  mlPaddleAdvance(&ml_pl, &fieldFence); /**< both paddles */
+  PROF_END(ZONE_PADDLES);
+  PROF_BEGIN(ZONE_BALL);
+  mlBallAdvance(ballMovers, &ml_pl, &fieldFence);
+  collideLayers(ballLayers, &fieldLayer, ballContact, 0); /**< balls and paddles only */
+  PROF_END(ZONE_BALL);
+  for (i = 0; i < PONG_BALLS; i++)
+    ballTo[i] = ballLayers[i].posNext;
+  MOVLAYER_WRITE_END();
+}
+
+/** Run the steps that sched_now says are due */
+static void
+simAdvance()
+{
+  u_char steps = 0;
+  unsigned int now = sched_now;
+  simAccum += now - simLast;
+  simLast = now;
+  while (simAccum >= STEP_TICKS && sceneFsm.state == SCENE_PLAY) {
+    if (steps++ == MAX_STEPS) { /**< too far behind: drop whole steps */
+      simAccum &= STEP_TICKS - 1;
+      simDropped++;
+      break;
+    }
+    simStep();
+    simAccum -= STEP_TICKS;
+  }
+}
+
+/** d * accum / STEP_TICKS by shift and add: no multiply hardware,
+ *  and accum (under STEP_TICKS) has only STEP_SHIFT bits */
+static int
+stepPart(int d, unsigned int accum)
+{
+  int sum = 0;
+  for (; accum; accum >>= 1, d += d)
+    if (accum & 1)
+      sum += d;
+  return sum >> STEP_SHIFT;
+}
+
+/** Place the balls simAccum/STEP_TICKS of the way through the current step */
+static void
+simInterpolate()
+{
+  u_char i, axis;
+  for (i = 0; i < PONG_BALLS; i++) {
+    for (axis = 0; axis < 2; axis++) {
+      int d = ballTo[i].axes[axis] - ballFrom[i].axes[axis];
+      ballLayers[i].posNext.axes[axis] = ballFrom[i].axes[axis]
+        + stepPart(d, simAccum);
+    }
+  }
+}
+
+/** Scheduled: nothing to do but wake main to render a frame */
+static void
+frameDue(void *unused)
+{
+}
+
+#ifdef TICKLESS
+static unsigned int p2swTicked; /**< sched_now when p2sw_tick last caught up */
+
+/** Tickless: the watchdog no longer calls p2sw_tick, so run the ticks
+ *  Timer A1 says have passed.  No lock outlasts P2SW_DEBOUNCE_TICKS,
+ *  so a longer sleep needs no more than that (p2sw_now then lags).
+ */
+static void
+p2swCatchUp()
+{
+  unsigned int behind = sched_now - p2swTicked;
+  if (behind > P2SW_DEBOUNCE_TICKS)
+    behind = P2SW_DEBOUNCE_TICKS;
+  p2swTicked = sched_now;
+  and_sr(~8);                   /**< p2sw_tick expects the port 2 handler held off */
+  while (behind--)
+    p2sw_tick();
+  or_sr(8);
+}
+#endif
+
+/** Posted by the tick interrupt when timers are due */
+static void
+runTimers(void *unused)
+{
+  sched_dispatch();
+}
 
 
 /** Initializes everything, enables interrupts and green LED, 
@@ -420,53 +591,107 @@ void main()
   P1DIR |= GREEN_LED;		/**< Green led on when CPU on */		
   P1OUT |= GREEN_LED;
 
-  configureClocks();
-  lcd_init();
+  configureClockProfile(CLOCK_PROFILE_SPI_8MHZ); /**< 4x faster lcd link, same tick */
+  lcd_initBegin();              /**< lcd resets while we set up the rest */
+  enableWDTInterrupts();        /**< the tick drives lcd initialization */
+  or_sr(0x8);	                /**< GIE (enable interrupts) */
+
   buzzer_init();
   shapeInit();
   p2sw_init(15);                /** initialize all switches */
 
   shapeInit();
 
+  while (!lcd_ready())          /**< sleep until the lcd is ready */
+    or_sr(0x10);                /**< CPU OFF */
+
   startscreen();
+  scene_wait();                 /**< LPM4 until a switch is pressed */
 
-  layerInit(&layerBall);
-  layerDraw(&layerBall);
+  layerInit(ballLayers);
+  layerDraw(ballLayers);
 
-  scoreDraw();
+  hudInvalidate(&hudPl, 0);
+  hudDraw(&hudPl);
 
   layerGetBounds(&fieldLayer, &fieldFence);
-
-
-  enableWDTInterrupts();      /**< enable periodic interrupt */
+  {
+    u_char i;
+    for (i = 0; i < PONG_BALLS; i++)
+      ballFrom[i] = ballTo[i] = ballLayers[i].posNext;
+  }
+  sched_add(frameDue, 0, FRAME_TICKS, FRAME_TICKS);
+  gov_init(FRAME_BUDGET_US);
+#ifdef PROFILE
+  prof_reset();
+#endif
+#ifdef DUTY
+  duty_reset();
+#endif
+
+
+#ifdef TICKLESS
+  tickless_init();            /**< Timer A1 wakes main only when a timer is due */
+  p2swTicked = sched_now;
+#endif
+  simLast = sched_now;
   or_sr(0x8);	              /**< GIE (enable interrupts) */
 
 
   for(;;) { 
+#ifdef TICKLESS
+    P1OUT &= ~GREEN_LED;      /**< Green led off witHo CPU */
+    tickless_sleep();         /**< LPM0 until the next deadline */
+    P1OUT |= GREEN_LED;       /**< Green led on when CPU on */
+    p2swCatchUp();            /**< debounce on Timer A1 time */
+    wq_drain();
+    sched_dispatch();
+#else
     while (!redrawScreen) { /**< Pause CPU if screen doesn't need updating */ 
       P1OUT &= ~GREEN_LED;    /**< Green led off witHo CPU */
-      or_sr(0x10);	      /**< CPU OFF */
+      DUTY_SLEEP();	      /**< CPU OFF */
     }
     P1OUT |= GREEN_LED;       /**< Green led on when CPU on */
     redrawScreen = 0;
-    movLayerDraw(&ml_ball, &layerBall);
-    scoreDraw();
-    //movePaddlesC();
-    movePaddles();
-    buzzer_set_period(0);
+    DUTY_FRAME();             /**< a frame runs from wake to wake */
+    wq_drain();               /**< work deferred by interrupt handlers */
+#endif
+    if (sceneFsm.state != SCENE_PLAY) {  /**< the game was won */
+      scene_wait();
+      simLast = sched_now;    /**< the menu's time is not simulated */
+      continue;
+    }
+    simAdvance();
+    if (sceneFsm.state != SCENE_PLAY)
+      continue;
+    gov_frameBegin();
+    simInterpolate();
+    PROF_BEGIN(ZONE_DRAW);
+    movLayerDraw(ballMovers, ballLayers);
+    PROF_END(ZONE_DRAW);
+    if (gov_lowPriorityDue()) { /**< HUD waits while frames run long */
+      PROF_BEGIN(ZONE_SCORE);
+      hudDraw(&hudPl);        /**< nothing to send unless something changed */
+      PROF_END(ZONE_SCORE);
+    }
+    gov_frameEnd();
   }
 }
 
-/** Watchdog timer interrupt handler. 15 interrupts/sec */
+/** Watchdog timer interrupt handler. 250 interrupts/sec */
 void wdt_c_handler()
 {
-  static short count = 0;
+  if (!wdtTickDue())
+    return;
+  DUTY_ISR_ENTER();                   /**< not asleep while handling the tick */
   P1OUT |= GREEN_LED;		      /**< Green LED on when cpu on */
-  count ++;
-  if (count == 15) {
-    mlBallAdvance(&ml_ball, &ml_plU, &ml_prU, &fieldFence);
-    redrawScreen = 1;
-    count = 0;
-  } 
+  if (p2sw_tick() && sceneFsm.state != SCENE_PLAY)
+    redrawScreen = 1;                 /**< wake a waiting scene: switches settled */
+  if (!lcd_ready()) {
+    if (lcd_initTick())
+      redrawScreen = 1;               /**< wake main: lcd is ready */
+  } else if (sched_tick() && !redrawScreen && wq_post(runTimers, 0))
+    redrawScreen = 1;                 /**< wake main to run due timers */
   P1OUT &= ~GREEN_LED;		    /**< Green LED off when cpu off */
+  DUTY_ISR_EXIT();
 }
@@ -5,7 +5,13 @@
 #define STOP 0
 #define REV -1 //take out
 
-void getScoreChar(int n, char s[]);
+#define GREEN_LED BIT6
+
+extern int redrawScreen;
+extern unsigned char switchesDown, switchesActive;
+
 void winscreen();
 void startscreen();
+void newgame();
+int pollSwitchEvents();
 #endif 
@@ -1,30 +1,62 @@
 #include <msp430.h>
+#include <libTimer.h>
+#include <p2switches.h>
 #include "stateMachines.h"
 #include "buzzer.h"
 #include "pong.h"
 
-void state_advance()		/* alternate between toggling red & green */
+static void
+act_win(Fsm *fsm, unsigned char event)
 {
+  winscreen();
+}
 
-  //static enum {R=0, G=1} color = R; // initial color
-  static enum {START, PLAY, WIN} state = START;
-  switch (state) 
-  {
-      case START: 
-          /* draw start screen */
-          state = PLAY;
-          startscreen();
-          break;
-      case PLAY:
-          state = WIN; 
-          winscreen();
-          break;
-      case WIN: 
-          state = START;
-          startscreen();
-          break;
-  }
+static void
+act_newgame(Fsm *fsm, unsigned char event)
+{
+  newgame();
 }
 
+enum { ACT_NONE, ACT_WIN, ACT_NEWGAME };
+
+static const FsmAction sceneActions[] = { 0, act_win, act_newgame };
 
+/* for each scene: PRESS, BOTH, WON */
+static const FsmCell sceneStart[SCENE_EVENTS] = {
+  {SCENE_PLAY, ACT_NONE}, {SCENE_PLAY, ACT_NONE}, {SCENE_START, ACT_NONE}
+};
+static const FsmCell scenePlay[SCENE_EVENTS] = {
+  {SCENE_PLAY, ACT_NONE}, {SCENE_PLAY, ACT_NONE}, {SCENE_WIN, ACT_WIN}
+};
+static const FsmCell sceneWin[SCENE_EVENTS] = {
+  {SCENE_WIN, ACT_NONE}, {SCENE_PLAY, ACT_NEWGAME}, {SCENE_WIN, ACT_NONE}
+};
+static const FsmCell * const sceneRows[] = { sceneStart, scenePlay, sceneWin };
+static const FsmTable sceneTable = { sceneRows, sceneActions, SCENE_EVENTS };
 
+Fsm sceneFsm = { &sceneTable, SCENE_START };
+
+void scene_wait()
+{
+  buzzer_stop();
+  while (sceneFsm.state != SCENE_PLAY) {
+    if (pollSwitchEvents() && switchesActive) { /* a press: the scene decides */
+      fsm_dispatch(&sceneFsm, (switchesDown & (BIT0 | BIT1)) == (BIT0 | BIT1)
+		   ? SCENE_EV_BOTH : SCENE_EV_PRESS);
+      continue;
+    }
+    and_sr(~8);			/* GIE off: no event slips in before we sleep */
+    if (!(IE1 & WDTIE))		/* tickless: nothing would finish debouncing */
+      p2sw_tickStop();
+    if (p2sw_pending()) {
+      or_sr(8);
+      continue;
+    }
+    P1OUT &= ~GREEN_LED;
+    if (p2sw_settled())
+      or_sr(0xf8);		/* LPM4 and GIE: only a switch wakes us */
+    else			/* (only while the watchdog ticks) */
+      or_sr(0x18);		/* LPM0 and GIE: the tick finishes debouncing */
+    P1OUT |= GREEN_LED;
+  }
+}
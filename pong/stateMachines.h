@@ -1,6 +1,29 @@
 #ifndef stateMachine_included
 #define stateMachine_included
 
-void state_advance();
+#include "fsmEngine.h"
+
+/** Scenes: the start menu, play, and the win screen */
+typedef enum {SCENE_START, SCENE_PLAY, SCENE_WIN} Scene;
+
+/** Scene events */
+enum {
+  SCENE_EV_PRESS,		/**< a switch was pressed */
+  SCENE_EV_BOTH,		/**< sw1 & sw2 are held together */
+  SCENE_EV_WON,			/**< a player reached MAX_SCORE */
+  SCENE_EVENTS
+};
+
+/** The scene machine: sceneFsm.state is the current Scene.
+ *  Events are sent with fsm_dispatch(&sceneFsm, event); entering a
+ *  scene draws it.
+ */
+extern Fsm sceneFsm;
+
+/** From main, in a waiting scene (START or WIN): sleep until the
+ *  switches select the next scene, then advance to it.  The CPU is in
+ *  LPM4 (all clocks off) unless a switch is still being debounced.
+ */
+void scene_wait();
 
 #endif // included
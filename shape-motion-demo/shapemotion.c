@@ -67,58 +67,10 @@ Layer layer0 = {		/**< Layer with an orange circle */
   &layer1,
 };
 
-/** Moving Layer
- *  Linked list of layer references
- *  Velocity represents one iteration of change (direction & magnitude)
- */
-typedef struct MovLayer_s {
-  Layer *layer;
-  Vec2 velocity;
-  struct MovLayer_s *next;
-} MovLayer;
-
 /* initial value of {0,0} will be overwritten */
-MovLayer ml3 = { &layer3, {1,1}, 0 }; /**< not all layers move */
-MovLayer ml1 = { &layer1, {1,2}, &ml3 }; 
-MovLayer ml0 = { &layer0, {2,1}, &ml1 }; 
-
-void movLayerDraw(MovLayer *movLayers, Layer *layers)
-{
-  int row, col;
-  MovLayer *movLayer;
-
-  and_sr(~8);			/**< disable interrupts (GIE off) */
-  for (movLayer = movLayers; movLayer; movLayer = movLayer->next) { /* for each moving layer */
-    Layer *l = movLayer->layer;
-    l->posLast = l->pos;
-    l->pos = l->posNext;
-  }
-  or_sr(8);			/**< disable interrupts (GIE on) */
-
-
-  for (movLayer = movLayers; movLayer; movLayer = movLayer->next) { /* for each moving layer */
-    Region bounds;
-    layerGetBounds(movLayer->layer, &bounds);
-    lcd_setArea(bounds.topLeft.axes[0], bounds.topLeft.axes[1], 
-		bounds.botRight.axes[0], bounds.botRight.axes[1]);
-    for (row = bounds.topLeft.axes[1]; row <= bounds.botRight.axes[1]; row++) {
-      for (col = bounds.topLeft.axes[0]; col <= bounds.botRight.axes[0]; col++) {
-	Vec2 pixelPos = {col, row};
-	u_int color = bgColor;
-	Layer *probeLayer;
-	for (probeLayer = layers; probeLayer; 
-	     probeLayer = probeLayer->next) { /* probe all layers, in order */
-	  if (abShapeCheck(probeLayer->abShape, &probeLayer->pos, &pixelPos)) {
-	    color = probeLayer->color;
-	    break; 
-	  } /* if probe check */
-	} // for checking all layers at col, row
-	lcd_writeColor(color); 
-      } // for col
-    } // for row
-  } // for moving layer being updated
-}	  
-
+MovLayer ml3 = { &layer3, {FIX_HALF,FIX_HALF}, 0 }; /**< redrawn every other step */
+MovLayer ml1 = { &layer1, {FIX(1),FIX(2)}, &ml3 }; 
+MovLayer ml0 = { &layer0, {FIX(2),FIX(1)}, &ml1 }; 
 
 
 //Region fence = {{10,30}, {SHORT_EDGE_PIXELS-10, LONG_EDGE_PIXELS-10}}; /**< Create a fence region */
@@ -130,17 +82,18 @@ void movLayerDraw(MovLayer *movLayers, Layer *layers)
  */
 void mlAdvance(MovLayer *ml, Region *fence)
 {
-  Vec2 newPos;
+  Vec2 newPos, move;
   u_char axis;
   Region shapeBoundary;
   for (; ml; ml = ml->next) {
-    vec2Add(&newPos, &ml->layer->posNext, &ml->velocity);
+    movLayerStep(ml, &move);
+    vec2Add(&newPos, &ml->layer->posNext, &move);
     abShapeGetBounds(ml->layer->abShape, &newPos, &shapeBoundary);
     for (axis = 0; axis < 2; axis ++) {
       if ((shapeBoundary.topLeft.axes[axis] < fence->topLeft.axes[axis]) ||
 	  (shapeBoundary.botRight.axes[axis] > fence->botRight.axes[axis]) ) {
-	int velocity = ml->velocity.axes[axis] = -ml->velocity.axes[axis];
-	newPos.axes[axis] += (2*velocity);
+	ml->velocity.axes[axis] = -ml->velocity.axes[axis];
+	newPos.axes[axis] -= (2*move.axes[axis]);
       }	/**< if outside of fence */
     } /**< for axis */
     ml->layer->posNext = newPos;
@@ -149,10 +102,26 @@ void mlAdvance(MovLayer *ml, Region *fence)
 
 
 u_int bgColor = COLOR_BLUE;     /**< The background color */
-int redrawScreen = 1;           /**< Boolean for whether screen needs to be redrawn */
+int redrawScreen = 1;           /**< Boolean for whether main has work (a timer is due) */
 
 Region fieldFence;		/**< fence around playing field  */
 
+/** Scheduled 15 ticks apart: advance the shapes and redraw them */
+static void
+shapeStep(void *unused)
+{
+  mlAdvance(&ml0, &fieldFence);
+  if (p2sw_read())
+    movLayerDraw(&ml0, &layer0);
+}
+
+/** Posted by the tick interrupt when timers are due */
+static void
+runTimers(void *unused)
+{
+  sched_dispatch();
+}
+
 
 /** Initializes everything, enables interrupts and green LED, 
  *  and handles the rendering for the screen
@@ -174,6 +143,7 @@ void main()
 
 
   layerGetBounds(&fieldLayer, &fieldFence);
+  sched_add(shapeStep, 0, 15, 15);
 
 
   enableWDTInterrupts();      /**< enable periodic interrupt */
@@ -187,21 +157,15 @@ void main()
     }
     P1OUT |= GREEN_LED;       /**< Green led on when CPU on */
     redrawScreen = 0;
-    movLayerDraw(&ml0, &layer0);
+    wq_drain();		      /**< work deferred by interrupt handlers */
   }
 }
 
-/** Watchdog timer interrupt handler. 15 interrupts/sec */
+/** Watchdog timer interrupt handler. 250 interrupts/sec */
 void wdt_c_handler()
 {
-  static short count = 0;
   P1OUT |= GREEN_LED;		      /**< Green LED on when cpu on */
-  count ++;
-  if (count == 15) {
-    mlAdvance(&ml0, &fieldFence);
-    if (p2sw_read())
-      redrawScreen = 1;
-    count = 0;
-  } 
+  if (sched_tick() && !redrawScreen && wq_post(runTimers, 0))
+    redrawScreen = 1;		      /**< wake main to run due timers */
   P1OUT &= ~GREEN_LED;		    /**< Green LED off when cpu off */
 }
@@ -0,0 +1,91 @@
+#include "shape.h"
+
+#if COLLIDE_MAX_LAYERS > 16
+#error "cell masks are 16 bits: at most 16 layers"
+#endif
+
+/* grid cell holding a coordinate, clamped to the grid */
+static u_char
+cellOf(int v, u_char cells)
+{
+  if (v < 0)
+    return 0;
+  v >>= COLLIDE_CELL_SHIFT;
+  return v >= cells ? cells - 1 : v;
+}
+
+/* first pixel (row major) within r contained by both layers' shapes */
+static int
+narrowphase(const Layer *a, const Layer *b, const Region *r, Vec2 *contact)
+{
+  Vec2 p;
+  for (p.axes[1] = r->topLeft.axes[1]; p.axes[1] <= r->botRight.axes[1]; p.axes[1]++)
+    for (p.axes[0] = r->topLeft.axes[0]; p.axes[0] <= r->botRight.axes[0]; p.axes[0]++)
+      if (abShapeCheck(a->abShape, &a->posNext, &p) &&
+	  abShapeCheck(b->abShape, &b->posNext, &p)) {
+	*contact = p;
+	return 1;
+      }
+  return 0;
+}
+
+u_char
+collideLayers(Layer *layers, Layer *end, CollideFn fn, void *arg)
+{
+  u_int cells[COLLIDE_ROWS][COLLIDE_COLS]; /* bit i: layer i touches the cell */
+  u_char n = 0, row, col, i, contacts = 0;
+  Layer *l;
+
+  for (row = 0; row < COLLIDE_ROWS; row++)
+    for (col = 0; col < COLLIDE_COLS; col++)
+      cells[row][col] = 0;
+
+  /* broadphase: bin each layer's bounds */
+  for (l = layers; l != end && n < COLLIDE_MAX_LAYERS; l = l->next, n++) {
+    Region b;
+    u_char colMin, colMax, rowMax;
+    u_int bit = 1u << n;
+    abShapeGetBounds(l->abShape, &l->posNext, &b);
+    colMin = cellOf(b.topLeft.axes[0], COLLIDE_COLS);
+    colMax = cellOf(b.botRight.axes[0], COLLIDE_COLS);
+    rowMax = cellOf(b.botRight.axes[1], COLLIDE_ROWS);
+    for (row = cellOf(b.topLeft.axes[1], COLLIDE_ROWS); row <= rowMax; row++)
+      for (col = colMin; col <= colMax; col++)
+	cells[row][col] |= bit;
+  }
+
+  /* pairs sharing a cell */
+  for (row = 0; row < COLLIDE_ROWS; row++) {
+    for (col = 0; col < COLLIDE_COLS; col++) {
+      u_int m = cells[row][col];
+      Layer *a, *b;		/* layers i and j, walked along the list */
+      for (i = 0, a = layers; m & (m - 1); i++, a = a->next) { /* while two or more bits remain */
+	u_int rest;
+	if (!(m & (1u << i)))
+	  continue;
+	m &= ~(1u << i);
+	for (b = a->next, rest = m >> (i + 1); rest; b = b->next, rest >>= 1) {
+	  Region ra, rb, overlap;
+	  Vec2 contact;
+	  if (!(rest & 1))
+	    continue;
+	  abShapeGetBounds(a->abShape, &a->posNext, &ra);
+	  abShapeGetBounds(b->abShape, &b->posNext, &rb);
+	  vec2Max(&overlap.topLeft, &ra.topLeft, &rb.topLeft);
+	  vec2Min(&overlap.botRight, &ra.botRight, &rb.botRight);
+	  if (overlap.topLeft.axes[0] > overlap.botRight.axes[0] ||
+	      overlap.topLeft.axes[1] > overlap.botRight.axes[1])
+	    continue;		/* bounds don't overlap */
+	  if (cellOf(overlap.topLeft.axes[0], COLLIDE_COLS) != col ||
+	      cellOf(overlap.topLeft.axes[1], COLLIDE_ROWS) != row)
+	    continue;		/* reported by the overlap's first cell */
+	  if (narrowphase(a, b, &overlap, &contact)) {
+	    contacts++;
+	    fn(a, b, &contact, arg);
+	  }
+	}
+      }
+    }
+  }
+  return contacts;
+}
@@ -0,0 +1,127 @@
+#include "lcdutils.h"
+#include "lcddraw.h"
+#include "lcdformat.h"
+#include "hud.h"
+
+#define HUD_CHAR_COLS 6		/* 5x7 glyph and a column of space */
+#define HUD_CHAR_ROWS 8
+
+/* current value of a widget's source */
+static int
+hudValue(const HudWidget *w)
+{
+  switch (w->kind) {
+  case HUD_COUNTER:
+    return *(const int *)w->src;
+  case HUD_BCD:
+    return *(const BcdCounter *)w->src;
+  case HUD_ICON:
+    return *(const u_char *)w->src;
+  }
+  return 0;
+}
+
+/* characters a counter occupies: no more than its buffer holds */
+static u_char
+hudDigits(const HudWidget *w)
+{
+  return w->width > HUD_DIGITS ? HUD_DIGITS : w->width;
+}
+
+/* icon bit k of a row, msb first */
+#define iconBit(rowBits, k) ((rowBits)[(k) >> 3] & (0x80 >> ((k) & 7)))
+
+/* icon bits, msb first per padded row, in one window: a burst per run
+ * of like pixels, or one run of bgColor when off */
+static void
+hudDrawIcon(const HudWidget *w, int on)
+{
+  u_char stride = (w->width + 7) >> 3;
+  const u_char *rowBits = w->icon;
+  u_char r, k, run;
+
+  lcd_setArea(w->col, w->row, w->col + w->width - 1, w->row + HUD_CHAR_ROWS - 1);
+  if (!on) {
+    lcd_writeColorRun(w->bgColor, w->width * HUD_CHAR_ROWS);
+    return;
+  }
+  for (r = 0; r < HUD_CHAR_ROWS; r++, rowBits += stride) {
+    for (k = 0; k < w->width; k += run) {
+      int clear = !iconBit(rowBits, k);
+      for (run = 1; k + run < w->width && (!iconBit(rowBits, k + run)) == clear; run++)
+	;
+      lcd_writeColorRun(clear ? w->bgColor : w->fgColor, run);
+    }
+  }
+}
+
+void
+hudGetBounds(const HudWidget *w, Region *bounds)
+{
+  u_char cols = w->width;
+  if (w->kind == HUD_COUNTER || w->kind == HUD_BCD)
+    cols = hudDigits(w) * HUD_CHAR_COLS;
+  else if (w->kind == HUD_LABEL)
+    cols *= HUD_CHAR_COLS;
+  bounds->topLeft.axes[0] = w->col;
+  bounds->topLeft.axes[1] = w->row;
+  bounds->botRight.axes[0] = w->col + cols - 1;
+  bounds->botRight.axes[1] = w->row + HUD_CHAR_ROWS - 1;
+}
+
+void
+hudInvalidate(const HudWidget *w, const Region *r)
+{
+  for (; w; w = w->next) {
+    Region b;
+    if (r) {
+      hudGetBounds(w, &b);
+      if (b.botRight.axes[0] < r->topLeft.axes[0] ||
+	  b.topLeft.axes[0] > r->botRight.axes[0] ||
+	  b.botRight.axes[1] < r->topLeft.axes[1] ||
+	  b.topLeft.axes[1] > r->botRight.axes[1])
+	continue;		/* clear of r */
+    }
+    w->state->dirty = 1;
+  }
+}
+
+u_char
+hudDraw(const HudWidget *w)
+{
+  u_char drawn = 0;
+  for (; w; w = w->next) {
+    HudState *st = w->state;
+    if (w->kind == HUD_LABEL) {
+      const char *text = *(const char * const *)w->src;
+      u_char len = 0;
+      if (!st->dirty && text == st->shown.text)
+	continue;
+      st->shown.text = text;
+      while (text[len])
+	len++;
+      drawString5x7(w->col, w->row, (char *)text, w->fgColor, w->bgColor);
+      if (len < w->width)	/* the rest of a longer, older label */
+	fillRectangle(w->col + len * HUD_CHAR_COLS, w->row,
+		      (w->width - len) * HUD_CHAR_COLS, HUD_CHAR_ROWS, w->bgColor);
+    } else {
+      int value = hudValue(w);
+      if (!st->dirty && value == st->shown.value)
+	continue;
+      st->shown.value = value;
+      if (w->kind == HUD_ICON)
+	hudDrawIcon(w, value);
+      else {
+	char s[HUD_DIGITS + 1];
+	if (w->kind == HUD_BCD)
+	  fmtBcd(s, value, hudDigits(w), 0);
+	else
+	  fmtSigned(s, value, hudDigits(w), 0);
+	drawString5x7(w->col, w->row, s, w->fgColor, w->bgColor);
+      }
+    }
+    st->dirty = 0;
+    drawn++;
+  }
+  return drawn;
+}
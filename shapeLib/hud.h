@@ -0,0 +1,69 @@
+/** \file hud.h
+ *  \brief Retained-mode HUD widgets: counters, labels and status icons.
+ *
+ *  Each widget watches a value in the program and remembers what it
+ *  last drew.  hudDraw() redraws only the widgets whose value changed
+ *  or that were invalidated (the screen was cleared, or something was
+ *  drawn over them), so a steady HUD sends nothing to the lcd.
+ */
+
+#ifndef hud_included
+#define hud_included
+
+#include "shape.h"
+
+/** Widget kinds */
+enum { HUD_COUNTER, HUD_BCD, HUD_LABEL, HUD_ICON };
+
+#define HUD_DIGITS 6		/**< widest counter: sign and 5 digits */
+
+/** What a widget last drew: its RAM, starting at 0 */
+typedef struct {
+  union {
+    int value;			/**< counters and icons */
+    const char *text;		/**< labels */
+  } shown;			/**< as last drawn */
+  u_char dirty;			/**< redraw whatever the value */
+} HudState;
+
+/** A HUD widget.  Widgets are const (they stay in flash); each points
+ *  at its own HudState.  Nothing is drawn until the widgets are
+ *  invalidated once.
+ *
+ *  HUD_COUNTER: src is an int, drawn in decimal right aligned in
+ *    width characters of the 5x7 font (a wider width is taken as
+ *    HUD_DIGITS).
+ *  HUD_BCD: as HUD_COUNTER, but src is a BcdCounter (lcdformat.h),
+ *    whose digits need no conversion.
+ *  HUD_LABEL: src is a char pointer variable holding the string
+ *    shown, redrawn when it points elsewhere; width is the longest
+ *    string's length, and shorter ones are padded with bgColor.
+ *  HUD_ICON: src is a u_char state; icon, a width x 8 bitmap in
+ *    lcdcanvas layout (rows padded to whole bytes, msb leftmost), is
+ *    drawn in fgColor while the state is nonzero, all bgColor otherwise.
+ */
+typedef struct HudWidget_s {
+  u_char kind;
+  u_char col, row;		/**< top left */
+  u_char width;			/**< characters, or pixels for icons */
+  u_int fgColor, bgColor;	/**< BGR */
+  const void *src;		/**< the value watched */
+  const u_char *icon;		/**< HUD_ICON only */
+  HudState *state;
+  const struct HudWidget_s *next;
+} HudWidget;
+
+/** Screen region a widget covers */
+void hudGetBounds(const HudWidget *w, Region *bounds);
+
+/** Mark the widgets overlapping r for redrawing, or all of them if r
+ *  is 0 (e.g. after clearScreen).
+ */
+void hudInvalidate(const HudWidget *widgets, const Region *r);
+
+/** Redraw the widgets that changed or were invalidated.
+ *  \return the number of widgets drawn
+ */
+u_char hudDraw(const HudWidget *widgets);
+
+#endif // included
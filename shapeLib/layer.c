@@ -1,29 +1,137 @@
 #include "lcdutils.h"
 #include "lcddraw.h"
 #include "shape.h"
+#include "profiler.h"
+
+#ifdef SHAPE_PALETTE
+typedef u_char LineColor;	/**< palette index */
+#define lcd_writeLine lcd_writeIndices
+#else
+typedef u_int LineColor;	/**< BGR */
+#define lcd_writeLine lcd_writeColors
+#endif
 
 void
 layerDraw(Layer *layers)
 {
-  int row, col;
-  for (row = 0; row < screenHeight; row++) {
-    lcd_setArea(0, row, screenWidth-1, row);
-    for (col = 0; col < screenWidth; col++) {
-      Vec2 pixelPos = {col, row};
-      u_int color = bgColor;
-      Layer *probeLayer;
-      for (probeLayer = layers; probeLayer; probeLayer = probeLayer->next) {
-	if (abShapeCheck(probeLayer->abShape, &probeLayer->pos, &pixelPos)) {
-	  color = probeLayer->color;
-	  break; 
-	} /* if check */
-      } // for checking all layers at col, row
-      lcd_writeColor(color); 
-    } // for col
-  } // for row
-} 
+  Region screen = {{0, 0}, {screenWidth-1, screenHeight-1}};
+  layerDrawRegion(layers, &screen);
+}
+
+/** Color of the first layer containing pixelPos, or bgColor */
+static u_int
+layerColorAt(Layer *layers, const Vec2 *pixelPos)
+{
+  Layer *probeLayer;
+  for (probeLayer = layers; probeLayer;
+       probeLayer = probeLayer->next) { /* probe all layers, in order */
+    if (abShapeCheck(probeLayer->abShape, &probeLayer->pos, pixelPos))
+      return probeLayer->color;
+  }
+  return bgColor;
+}
+
+void
+layerDrawRegion(Layer *layers, const Region *r)
+{
+  LineColor lineBuf[LINEBUF_PIXELS];
+  int row, col, runStart, rowStart, rowLimit;
+  int colLimit = r->botRight.axes[0] + 1;
+
+  for (rowStart = r->topLeft.axes[1]; rowStart <= r->botRight.axes[1];
+       rowStart = rowLimit) {	/* rows contiguous in (scrolled) lcd memory */
+    u_char memRow = lcd_scrollRow(rowStart);
+    rowLimit = rowStart + lcd_scrollRun(rowStart, r->botRight.axes[1]);
+    lcd_setArea(r->topLeft.axes[0], memRow,
+		r->botRight.axes[0], memRow + (rowLimit - rowStart) - 1);
+    for (row = rowStart; row < rowLimit; row++) {
+      for (runStart = r->topLeft.axes[0]; runStart < colLimit;
+	   runStart += LINEBUF_PIXELS) {
+	int runLimit = runStart + LINEBUF_PIXELS;
+	LineColor *p = lineBuf;
+	if (runLimit > colLimit)
+	  runLimit = colLimit;
+	/* compose the run while the previous burst's last byte shifts out */
+	for (col = runStart; col < runLimit; col++) {
+	  Vec2 pixelPos = {col, row};
+	  *p++ = layerColorAt(layers, &pixelPos);
+	} // for col
+	PROF_BEGIN(SHAPE_PROF_SPI);
+	lcd_writeLine(lineBuf, runLimit - runStart);
+	PROF_END(SHAPE_PROF_SPI);
+      } // for run
+    } // for row
+  } // for span of rows
+}
+
+void
+layerScroll(Layer *layers, int rows)
+{
+  Layer *l;
+  Region exposed;
+  Vec2 shift = {0, rows};
+  u_char lines = lcd_scrollLines;
+  int offset = lcd_scrollOffset + rows;
 
+  if (!lines)
+    return;
+  while (offset < 0)		/* avoid % (no hardware divider) */
+    offset += lines;
+  while (offset >= lines)
+    offset -= lines;
+  lcd_setScrollOffset(offset);
 
+  for (l = layers; l; l = l->next) { /* content moves with the band */
+    vec2Sub(&l->pos, &l->pos, &shift);
+    vec2Sub(&l->posLast, &l->posLast, &shift);
+    vec2Sub(&l->posNext, &l->posNext, &shift);
+  }
+  regionScrollExposed(&exposed, rows);
+  if (exposed.topLeft.axes[1] <= exposed.botRight.axes[1])
+    layerDrawRegion(layers, &exposed);
+}
+
+void
+movLayerStep(MovLayer *ml, Vec2 *move)
+{
+  u_char axis;
+  for (axis = 0; axis < 2; axis++) {
+    int sum = ml->frac[axis] + ml->velocity.axes[axis];
+    ml->frac[axis] = sum;	/* low byte: what's left of a pixel */
+    move->axes[axis] = sum >> FIX_SHIFT; /* floor: frac stays positive */
+  }
+}
+
+volatile u_int movLayerSeq;
+
+void
+movLayerDraw(MovLayer *movLayers, Layer *layers)
+{
+  MovLayer *movLayer;
+  u_int seq;
+
+  for (movLayer = movLayers; movLayer; movLayer = movLayer->next)
+    movLayer->layer->posLast = movLayer->layer->pos; /* pos is only ours */
+  do {				/* a writer interrupting the copy: copy again */
+    seq = movLayerSeq;
+    MOVLAYER_BARRIER();		/* copy after reading seq... */
+    for (movLayer = movLayers; movLayer; movLayer = movLayer->next) {
+      Layer *l = movLayer->layer;
+      l->pos = l->posNext;
+    }
+    MOVLAYER_BARRIER();		/* ...and before reading it again */
+  } while ((seq & 1) || seq != movLayerSeq);
+
+  for (movLayer = movLayers; movLayer; movLayer = movLayer->next) { /* for each moving layer */
+    Region bounds;
+    Layer *l = movLayer->layer;
+    if (l->pos.axes[0] == l->posLast.axes[0] &&
+	l->pos.axes[1] == l->posLast.axes[1])
+      continue;			/* didn't move: nothing to redraw */
+    layerGetBounds(l, &bounds);
+    layerDrawRegion(layers, &bounds);
+  } // for moving layer being updated
+}
 
 void
 layerGetBounds(const Layer *l, Region *bounds)
@@ -15,3 +15,24 @@ void regionClipScreen(Region *r)
   vec2Min(&r->botRight, &r->botRight, &screenSize);
 }
 
+
+// Strip of the scrolling band exposed by scrolling its content up
+// by rows (down if negative)
+void regionScrollExposed(Region *r, int rows)
+{
+  int top = lcd_scrollTop, limit = lcd_scrollTop + lcd_scrollLines;
+  if (rows < 0) {
+    rows = -rows;
+    limit = top + rows;
+  } else {
+    top = limit - rows;
+  }
+  if (rows > lcd_scrollLines) {	/* the whole band */
+    top = lcd_scrollTop;
+    limit = lcd_scrollTop + lcd_scrollLines;
+  }
+  r->topLeft.axes[0] = 0;
+  r->topLeft.axes[1] = top;
+  r->botRight.axes[0] = screenWidth - 1;
+  r->botRight.axes[1] = limit - 1;
+}
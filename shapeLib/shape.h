@@ -62,6 +62,40 @@ void regionUnion(Region *rUnion, const Region *r1, const Region *r2);
  */
 void regionClipScreen(Region *region);
 
+/** Computes the strip of lcdLib's scrolling band (see lcd_setScrollArea)
+ *  that is newly exposed when its content scrolls up by rows
+ *  (down if rows is negative).  Empty (botRight above topLeft)
+ *  if rows is 0.
+ */
+void regionScrollExposed(Region *r, int rows);
+
+/** Swept collision: when, during one step, a region moving by d
+ *  first touches another.  Times are fractions of the step, 0 to
+ *  SWEEP_ONE, computed without multiply or divide hardware.
+ *  Any AbShape (rect, circle...) can be swept by its bounds
+ *  (abShapeGetBounds).
+ */
+#define SWEEP_ONE 256
+
+typedef struct {
+  u_int time;			/**< of contact, 0 ... SWEEP_ONE */
+  u_char axis;			/**< whose faces met: 0 col, 1 row */
+} SweepHit;
+
+/** Moving region a (displaced by d over the step) against fixed
+ *  region b.  Regions already overlapping at the start don't hit.
+ *  \return 1 if they touch during the step (hit is then set)
+ */
+int sweepRegion(const Region *a, const Vec2 *d, const Region *b, SweepHit *hit);
+
+/** Moving region a, inside fence, against fence's walls.
+ *  \return 1 if a would cross a wall during the step (hit is then set)
+ */
+int sweepFence(const Region *a, const Vec2 *d, const Region *fence, SweepHit *hit);
+
+/** The part of d covered by time (a SweepHit time), rounded toward 0 */
+void sweepPartial(Vec2 *part, const Vec2 *d, u_int time);
+
 /** This function initializes the screen
  *  vectors that are used by shapes
  *
@@ -157,6 +191,10 @@ int abRectOutlineCheck(const AbRect *rect, const Vec2 *centerPos, const Vec2 *pi
  *   - the layer's current position
  *   - the layer's color
  *   - a reference to the next (lower) layer.
+ *
+ *  When shapeLib is built with SHAPE_PALETTE defined, layer colors
+ *  (and bgColor) are indices into lcdLib's lcd_palette (e.g.
+ *  LCD_PAL_RED) rather than BGR values.
  */
 typedef struct Layer_s {
   AbShape *abShape;
@@ -179,6 +217,126 @@ void layerInit(Layer *layers);
  */
 void layerDraw(Layer *layers);
 
+/** Scroll the content of lcdLib's scrolling band up by rows (down if
+ *  negative) using the lcd's hardware scroll.  Positions of layers are
+ *  moved along with the band and only the newly exposed strip is
+ *  redrawn.
+ *
+ *  \param layers The layers that live in the scrolling band
+ */
+void layerScroll(Layer *layers, int rows);
+
+/** Pixels composed into RAM before each burst to the lcd.
+ *  Costs 2 bytes of stack per pixel (1 with SHAPE_PALETTE) while a
+ *  region is drawn; rebuild shapeLib with -DLINEBUF_PIXELS=n to trade
+ *  RAM for speed.
+ */
+#ifndef LINEBUF_PIXELS
+#define LINEBUF_PIXELS 32
+#endif
+
+/** Profiler zone (timerLib's profiler.h) timing each burst to the lcd,
+ *  when shapeLib is built with -DPROFILE: the last one */
+#define SHAPE_PROF_SPI (PROF_ZONES - 1)
+
+/** Render all layers within region r (inclusive of botRight).
+ *  Each row is composed into a line buffer of up to LINEBUF_PIXELS
+ *  colors which is then streamed to the lcd in a single burst.
+ *  Rows are in screen coordinates: when the lcd is scrolled, they are
+ *  mapped to the frame memory rows currently displayed there.
+ */
+void layerDrawRegion(Layer *layers, const Region *r);
+
+/** Fixed point: 8.8, in 1/256ths of a pixel.
+ *  Adds and shifts only: nothing needs multiply or divide hardware.
+ *  Right shifts of negative values are arithmetic (floor) with gcc.
+ */
+typedef int Fix8;
+#define FIX_SHIFT 8
+#define FIX_ONE (1 << FIX_SHIFT)
+#define FIX_HALF (FIX_ONE >> 1)
+#define FIX(pixels) ((Fix8)((pixels) * FIX_ONE)) /**< for constants (folded) */
+#define FIX_ROUND(f) (((f) + FIX_HALF) >> FIX_SHIFT) /**< to the nearest pixel */
+
+/** Moving Layer
+ *  Linked list of layer references
+ *  Velocity represents one iteration of change (direction & magnitude),
+ *  in 8.8 fixed point, so a layer can move less than a pixel per step.
+ *  The layer's position is posNext plus frac 256ths of a pixel.
+ */
+typedef struct MovLayer_s {
+  Layer *layer;
+  Vec2 velocity;		/**< Fix8 pixels per step, under 127 */
+  struct MovLayer_s *next;
+  u_char frac[2];		/**< sub-pixel position (starts at 0) */
+} MovLayer;
+
+/** Whole pixels the layer moves this step (floor of frac + velocity).
+ *  The remainder stays in frac; the caller adds move to posNext
+ *  once it has been fenced.
+ */
+void movLayerStep(MovLayer *ml, Vec2 *move);
+
+/** Position commit sequence, odd while posNext is being written.
+ *
+ *  Writers of posNext, typically interrupt handlers, bracket their
+ *  updates with MOVLAYER_WRITE_BEGIN and MOVLAYER_WRITE_END (each a
+ *  single, uninterruptible increment).  The only reader is main:
+ *  movLayerDraw copies the positions with interrupts enabled and
+ *  copies them again if a writer ran meanwhile, so a writer never
+ *  waits.  Never draw from an interrupt handler: one that interrupted
+ *  a writer in main would retry forever.
+ */
+extern volatile u_int movLayerSeq;
+
+/** Keeps the compiler from moving (non-volatile) position accesses
+ *  across the sequence count's */
+#define MOVLAYER_BARRIER() __asm__ volatile("" ::: "memory")
+#define MOVLAYER_WRITE_BEGIN() do {		\
+    movLayerSeq++;				\
+    MOVLAYER_BARRIER();				\
+  } while (0)
+#define MOVLAYER_WRITE_END() do {		\
+    MOVLAYER_BARRIER();				\
+    movLayerSeq++;				\
+  } while (0)
+
+/** Commit each moving layer's posNext and redraw the region it
+ *  vacated and now occupies.  Layers that did not move are skipped,
+ *  so one moving by a fraction of a pixel per step is redrawn only
+ *  on the steps its pixel position changes.
+ *
+ *  \param movLayers The moving layers to update
+ *  \param layers The layers to probe (in order) when redrawing
+ */
+void movLayerDraw(MovLayer *movLayers, Layer *layers);
+
+/** Collisions between layers
+ *
+ *  collideLayers bins each layer's bounds (at posNext) into a coarse
+ *  grid over the screen, one bit per layer per cell.  Only layers
+ *  sharing a cell are paired, and only pairs whose bounds overlap are
+ *  tested pixel by pixel with their AbShapes' check, within the
+ *  overlap.  Each pair is reported once, at the first pixel both
+ *  shapes contain.
+ */
+#ifndef COLLIDE_MAX_LAYERS
+#define COLLIDE_MAX_LAYERS 16	/**< layers beyond this are not tested */
+#endif
+#define COLLIDE_CELL_SHIFT 5	/**< cells are 32x32 pixels */
+#define COLLIDE_COLS ((screenWidth + 31) >> COLLIDE_CELL_SHIFT)
+#define COLLIDE_ROWS ((screenHeight + 31) >> COLLIDE_CELL_SHIFT)
+
+typedef void (*CollideFn)(Layer *a, Layer *b, const Vec2 *contact, void *arg);
+
+/** Report contacts among layers, up to (not including) end, to fn
+ *  (a before b in the list).  Put layers that never move, such as a
+ *  field outline covering every cell, at or after end: they would be
+ *  paired with everything.
+ *  \return the number of contacts
+ */
+u_char collideLayers(Layer *layers, Layer *end, CollideFn fn, void *arg);
+
 /** Background color.
   */
 extern u_int bgColor;		/*  background color */
@@ -0,0 +1,117 @@
+#include "shape.h"
+
+/* num * SWEEP_ONE / den for 0 <= num <= den, by shift and subtract */
+static u_int
+fraction(u_int num, u_int den)
+{
+  u_int q = 0;
+  u_char bit;
+  if (num >= den)
+    return SWEEP_ONE;
+  for (bit = 0; bit < 8; bit++) { /* SWEEP_ONE is 1 << 8 */
+    num <<= 1;
+    q <<= 1;
+    if (num >= den) {
+      num -= den;
+      q |= 1;
+    }
+  }
+  return q;
+}
+
+/* n * |v| by shift and add (small values, no hardware multiplier) */
+static long
+times(int n, int v)
+{
+  long product = 0, m = n;
+  if (v < 0)
+    v = -v;
+  for (; v; v >>= 1, m <<= 1)
+    if (v & 1)
+      product += m;
+  return product;
+}
+
+int
+sweepRegion(const Region *a, const Vec2 *d, const Region *b, SweepHit *hit)
+{
+  /* per axis: entry and exit distances along |d| (times are dist/|d|) */
+  int entry[2], exit[2], len[2];
+  u_char axis, last = 2;
+
+  for (axis = 0; axis < 2; axis++) {
+    int v = d->axes[axis];
+    if (v > 0) {
+      entry[axis] = b->topLeft.axes[axis] - a->botRight.axes[axis];
+      exit[axis] = b->botRight.axes[axis] - a->topLeft.axes[axis];
+      len[axis] = v;
+    } else if (v < 0) {
+      entry[axis] = a->topLeft.axes[axis] - b->botRight.axes[axis];
+      exit[axis] = a->botRight.axes[axis] - b->topLeft.axes[axis];
+      len[axis] = -v;
+    } else {			/* not moving: must already overlap */
+      if (a->botRight.axes[axis] < b->topLeft.axes[axis] ||
+	  a->topLeft.axes[axis] > b->botRight.axes[axis])
+	return 0;
+      continue;
+    }
+    if (entry[axis] > len[axis] || exit[axis] < 0)
+      return 0;			/* not within this step */
+    /* the later entry decides the contact: e0/l0 > e1/l1 */
+    if (last == 2 ||
+	times(entry[axis], len[last]) > times(entry[last], len[axis]))
+      last = axis;
+  }
+  if (last == 2 || entry[last] < 0)
+    return 0;			/* not moving, or overlapping already */
+  for (axis = 0; axis < 2; axis++)	/* entered before either exits */
+    if (axis != last && d->axes[axis] &&
+	times(entry[last], len[axis]) > times(exit[axis], len[last]))
+      return 0;
+  hit->axis = last;
+  hit->time = fraction(entry[last], len[last]);
+  return 1;
+}
+
+int
+sweepFence(const Region *a, const Vec2 *d, const Region *fence, SweepHit *hit)
+{
+  int dist[2], len[2];
+  u_char axis, first = 2;
+
+  for (axis = 0; axis < 2; axis++) {
+    int v = d->axes[axis];
+    if (v > 0) {
+      dist[axis] = fence->botRight.axes[axis] - a->botRight.axes[axis];
+      len[axis] = v;
+    } else if (v < 0) {
+      dist[axis] = a->topLeft.axes[axis] - fence->topLeft.axes[axis];
+      len[axis] = -v;
+    } else
+      continue;
+    if (dist[axis] >= len[axis])
+      continue;			/* stays inside this step */
+    if (dist[axis] < 0)
+      dist[axis] = 0;		/* already through: hit at once */
+    /* the earlier crossing: d0/l0 < d1/l1 */
+    if (first == 2 ||
+	times(dist[axis], len[first]) < times(dist[first], len[axis]))
+      first = axis;
+  }
+  if (first == 2)
+    return 0;
+  hit->axis = first;
+  hit->time = fraction(dist[first], len[first]);
+  return 1;
+}
+
+void
+sweepPartial(Vec2 *part, const Vec2 *d, u_int time)
+{
+  u_char axis;
+  for (axis = 0; axis < 2; axis++) {
+    int v = d->axes[axis];
+    long p = times(v < 0 ? -v : v, time) >> 8; /* / SWEEP_ONE */
+    part->axes[axis] = v < 0 ? -p : p;
+  }
+}
@@ -1,27 +1,71 @@
 #include <msp430.h>
 #include "libTimer.h"
 
-void configureClocks(){
+/** Settings that depend on the clock profile (defaults: CLOCK_PROFILE_DEFAULT) */
+unsigned char clockSmclkShift = 3;   /**< SMCLK = 16MHz >> clockSmclkShift */
+unsigned char clockSpiDivider = 1;   /**< SPI clock = SMCLK / clockSpiDivider */
+unsigned char clockWdtPrescale = 1;  /**< WDT interrupts per tick */
+unsigned char clockTickShift = 13;   /**< a tick is 1 << clockTickShift SMCLK cycles */
+static unsigned char wdtInterval = 1; /**< WDTIS: 0 is SMCLK/32768, 1 is SMCLK/8192 */
+static unsigned char wdtPrescaleCount = 0;
+
+void configureClockProfile(ClockProfile profile)
+{
   WDTCTL = WDTPW + WDTHOLD;//Disable Watchdog Timer
   BCSCTL1 = CALBC1_16MHZ;  // Set DCO to 16 Mhz
   DCOCTL = CALDCO_16MHZ;
-    
-  BCSCTL2 &= ~(SELS);     // SMCLK source = DCO
-  BCSCTL2 |= DIVS_3;      // SMCLK = DCO / 8
+
+  clockSpiDivider = 1;
+  clockWdtPrescale = 1;
+  switch (profile) {
+  case CLOCK_PROFILE_SPI_4MHZ:
+    clockSpiDivider = 2;   // fall through: SMCLK = 8MHz
+  case CLOCK_PROFILE_SPI_8MHZ:
+    clockSmclkShift = 1;
+    wdtInterval = 0;	   // 8MHz / 32768: same tick as the default
+    clockTickShift = 15;
+    break;
+  case CLOCK_PROFILE_SPI_16MHZ:
+    clockSmclkShift = 0;
+    wdtInterval = 0;	   // 16MHz / 32768: twice the default tick...
+    clockWdtPrescale = 2;  // ...so every other interrupt is a tick
+    clockTickShift = 16;
+    break;
+  default:
+    clockSmclkShift = 3;
+    wdtInterval = 1;	   // 2MHz / 8192
+    clockTickShift = 13;
+  }
+  wdtPrescaleCount = 0;
+
+  BCSCTL2 &= ~(SELS | DIVS_3); // SMCLK source = DCO
+  BCSCTL2 |= clockSmclkShift << 1; // SMCLK = DCO >> clockSmclkShift (DIVS_x)
+}
+
+void configureClocks(){
+  configureClockProfile(CLOCK_PROFILE_DEFAULT);
 }
 
 
 // enable watchdog timer periodic interrupt
-// period = SMCLOCK/32k
+// period = SMCLOCK/8192 (or /32768 when SMCLK is faster), about 250Hz
 void enableWDTInterrupts()  
 {
   WDTCTL = WDTPW |	   // passwd req'd.  Otherwise device resets
     WDTTMSEL |		     // watchdog interval mode 
     WDTCNTCL |		     // clear watchdog count
-    1;			     // divide SMCLK by 8192
+    wdtInterval;	     // divide SMCLK by 8192 (1) or 32768 (0)
   IE1 |= WDTIE;		   // Enable watchdog interval timer interrupt
 }
 
+int wdtTickDue()
+{
+  if (++wdtPrescaleCount < clockWdtPrescale)
+    return 0;
+  wdtPrescaleCount = 0;
+  return 1;
+}
+
 
 void timerAUpmode()
 {
@@ -31,8 +75,9 @@ void timerAUpmode()
   
   // Timer A control:
   //  Timer clock source 2: system clock (SMCLK)
+  //  Input divider: SMCLK back down to 2MHz so periods are profile independent
   //  Mode Control 1: continuously 0...CCR0
-  TACTL = TASSEL_2 + MC_1;   
+  TACTL = TASSEL_2 + ((3 - clockSmclkShift) << 6) + MC_1;
 }
 
 
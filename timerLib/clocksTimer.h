@@ -1,8 +1,38 @@
 #ifndef timerLib_included
 #define timerLib_included
 
-void configureClocks();
+/** Clock profiles
+ *
+ *  MCLK is always the 16MHz DCO.  Profiles choose SMCLK, which clocks
+ *  the lcd's SPI link, the watchdog tick and Timer A.  The tick stays
+ *  at about 250Hz and Timer A at 2MHz in every profile, so game timing
+ *  and buzzer pitch do not change.
+ */
+typedef enum {
+  CLOCK_PROFILE_DEFAULT,	/**< SMCLK 2MHz, SPI 2MHz (configureClocks) */
+  CLOCK_PROFILE_SPI_4MHZ,	/**< SMCLK 8MHz, SPI 4MHz */
+  CLOCK_PROFILE_SPI_8MHZ,	/**< SMCLK 8MHz, SPI 8MHz */
+  CLOCK_PROFILE_SPI_16MHZ	/**< SMCLK 16MHz, SPI 16MHz (at the ST7735's limit) */
+} ClockProfile;
+
+/** Configure clocks for profile.  Call before lcd_init, 
+ *  enableWDTInterrupts and timerAUpmode, which all follow it.
+ */
+void configureClockProfile(ClockProfile profile);
+void configureClocks();		/**< CLOCK_PROFILE_DEFAULT */
+
+extern unsigned char clockSmclkShift;  /**< SMCLK = 16MHz >> clockSmclkShift */
+extern unsigned char clockSpiDivider;  /**< SPI clock = SMCLK / clockSpiDivider */
+extern unsigned char clockWdtPrescale; /**< WDT interrupts per tick */
+extern unsigned char clockTickShift;   /**< a tick is 1 << clockTickShift SMCLK cycles */
+
 void enableWDTInterrupts();
+
+/** Call first in the WDT handler: true if this interrupt is a tick.
+ *  (Only CLOCK_PROFILE_SPI_16MHZ interrupts faster than it ticks.)
+ */
+int wdtTickDue();
+
 void timerAUpmode();
 
 #endif
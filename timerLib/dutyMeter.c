@@ -0,0 +1,123 @@
+#include <msp430.h>
+#include "libTimer.h"
+#include "dutyMeter.h"
+
+DutyFrame dutyLastFrame;
+
+static unsigned char dutyState = DUTY_ACTIVE;
+static unsigned long lastMark;	/**< Timer A1 count at the last state change */
+static unsigned long frameCounts[2]; /**< this frame, indexed by state */
+
+/* The window holds each frame's counts >> SLOT_SHIFT, saturating */
+#define SLOT_SHIFT 4
+static unsigned int slotActive[DUTY_WINDOW], slotTotal[DUTY_WINDOW];
+static unsigned long sumActive, sumTotal;
+static unsigned char slot;
+
+/** Charge the time just spent to dutyState and switch to state.
+ *  Call with interrupts off.
+ */
+static void
+duty_mark(unsigned char state)
+{
+  unsigned long now = timerA1Now();
+  frameCounts[dutyState] += now - lastMark;
+  lastMark = now;
+  dutyState = state;
+}
+
+void
+duty_reset()
+{
+  unsigned char i;
+  timerA1Start();
+  for (i = 0; i < DUTY_WINDOW; i++)
+    slotActive[i] = slotTotal[i] = 0;
+  sumActive = sumTotal = 0;
+  frameCounts[DUTY_ACTIVE] = frameCounts[DUTY_ASLEEP] = 0;
+  dutyState = DUTY_ACTIVE;
+  lastMark = timerA1Now();
+}
+
+void
+duty_sleep()
+{
+  and_sr(~8);			/* GIE off: no handler sees a half-made mark */
+  duty_mark(DUTY_ASLEEP);
+  or_sr(0x18);			/* CPU OFF and GIE on, atomically */
+  and_sr(~8);
+  duty_mark(DUTY_ACTIVE);
+  or_sr(8);
+}
+
+unsigned char
+duty_isrEnter()
+{
+  unsigned char was = dutyState;
+  if (was == DUTY_ASLEEP)
+    duty_mark(DUTY_ACTIVE);
+  return was;
+}
+
+void
+duty_isrExit(unsigned char was)
+{
+  if (was == DUTY_ASLEEP)
+    duty_mark(DUTY_ASLEEP);
+}
+
+/** x / 1000 by shifts: about 0.055% low (x * 0.00099945), and less
+ *  than 3 lower still from truncating each shift */
+static unsigned long
+div1000(unsigned long x)
+{
+  return (x >> 10) + (x >> 16) + (x >> 17);
+}
+
+/** Microseconds in counts Timer A1 counts (1us = 16 CPU cycles) */
+static unsigned long
+countsToUs(unsigned long counts)
+{
+  return (counts << timerA1CycleShift) >> 4;
+}
+
+void
+duty_frame()
+{
+  unsigned long active, asleep, total;
+
+  and_sr(~8);
+  duty_mark(DUTY_ACTIVE);
+  active = frameCounts[DUTY_ACTIVE];
+  asleep = frameCounts[DUTY_ASLEEP];
+  frameCounts[DUTY_ACTIVE] = frameCounts[DUTY_ASLEEP] = 0;
+  or_sr(8);
+
+  dutyLastFrame.active = active;
+  dutyLastFrame.asleep = asleep;
+  /* uA * us = pC; frames up to about a second fit in 32 bits */
+  dutyLastFrame.charge = div1000(countsToUs(active) * DUTY_ACTIVE_UA
+				 + countsToUs(asleep) * DUTY_LPM0_UA);
+  dutyLastFrame.energy = div1000(dutyLastFrame.charge * DUTY_SUPPLY_MV);
+
+  active >>= SLOT_SHIFT;
+  total = active + (asleep >> SLOT_SHIFT);
+  while (total > 0xffff) {	/* long frame: keep the ratio */
+    active >>= 1;
+    total >>= 1;
+  }
+  sumActive += active - slotActive[slot];
+  sumTotal += total - slotTotal[slot];
+  slotActive[slot] = active;
+  slotTotal[slot] = total;
+  if (++slot == DUTY_WINDOW)
+    slot = 0;
+}
+
+unsigned char
+duty_busyPercent()
+{
+  if (!sumTotal)
+    return 0;
+  return (sumActive * 100) / sumTotal;
+}
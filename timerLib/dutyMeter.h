@@ -0,0 +1,76 @@
+#ifndef dutyMeter_included
+#define dutyMeter_included
+
+/** Duty cycle meter
+ *
+ *  Splits Timer A1 time into active and asleep (LPM0): main sleeps
+ *  with duty_sleep rather than or_sr(0x10), and interrupt handlers
+ *  that may run while main sleeps bracket their work with
+ *  duty_isrEnter and duty_isrExit.  duty_frame, called once per frame,
+ *  closes the frame, estimates its charge and energy, and adds it to
+ *  a sliding window of the last DUTY_WINDOW frames.
+ *
+ *  Programs that define DUTY before including this header can use the
+ *  DUTY_ macros, which otherwise reduce to a plain sleep or nothing.
+ */
+
+#ifndef DUTY_WINDOW
+#define DUTY_WINDOW 8		/**< frames in the sliding window (4 bytes each) */
+#endif
+
+/** Supply current estimates at MCLK 16MHz and 3V.  Rough figures:
+ *  measure your own board and override them.
+ */
+#ifndef DUTY_ACTIVE_UA
+#define DUTY_ACTIVE_UA 4200	/**< CPU on */
+#endif
+#ifndef DUTY_LPM0_UA
+#define DUTY_LPM0_UA 900	/**< CPU off, DCO and SMCLK on */
+#endif
+#ifndef DUTY_SUPPLY_MV
+#define DUTY_SUPPLY_MV 3000
+#endif
+
+enum { DUTY_ACTIVE, DUTY_ASLEEP };
+
+/** The most recent frame closed by duty_frame */
+typedef struct {
+  unsigned long active, asleep;	/**< Timer A1 counts */
+  unsigned long charge;		/**< nC (estimated) */
+  unsigned long energy;		/**< nJ (estimated) */
+} DutyFrame;
+
+extern DutyFrame dutyLastFrame;
+
+/** Start measuring (starts Timer A1): the current frame begins now */
+void duty_reset();
+
+/** From main: sleep in LPM0 until an interrupt handler wakes main */
+void duty_sleep();
+
+/** From interrupt handlers: time spent here is not asleep */
+unsigned char duty_isrEnter();
+void duty_isrExit(unsigned char was);	/**< was: from duty_isrEnter */
+
+/** From main, once per frame: close the current frame */
+void duty_frame();
+
+/** Percent of the window's time the CPU was active.  This divides,
+ *  which is slow without a hardware divider: call it to display the
+ *  figure, not every frame.
+ */
+unsigned char duty_busyPercent();
+
+#ifdef DUTY
+#define DUTY_SLEEP() duty_sleep()
+#define DUTY_ISR_ENTER() unsigned char dutyWas = duty_isrEnter()
+#define DUTY_ISR_EXIT() duty_isrExit(dutyWas)
+#define DUTY_FRAME() duty_frame()
+#else
+#define DUTY_SLEEP() or_sr(0x10)	/**< CPU OFF */
+#define DUTY_ISR_ENTER()
+#define DUTY_ISR_EXIT()
+#define DUTY_FRAME()
+#endif
+
+#endif // included
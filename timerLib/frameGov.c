@@ -0,0 +1,51 @@
+#include "libTimer.h"
+#include "frameGov.h"
+
+GovStats govStats;
+unsigned char govLevel;
+
+static unsigned long budget;	/**< Timer A1 counts */
+static unsigned long relax;	/**< 3/4 of the budget: a good frame */
+static unsigned long frameStart;
+static unsigned char goodFrames, frameCount;
+
+void
+gov_init(unsigned long budgetMicroseconds)
+{
+  timerA1Start();
+  budget = (budgetMicroseconds << 4) >> timerA1CycleShift; /* 16 cycles/us */
+  relax = budget - (budget >> 2);
+  govStats.frames = govStats.overruns = 0;
+  govLevel = goodFrames = frameCount = 0;
+  frameStart = timerA1Now();
+}
+
+void
+gov_frameBegin()
+{
+  frameStart = timerA1Now();
+  frameCount++;
+}
+
+void
+gov_frameEnd()
+{
+  unsigned long elapsed = timerA1Now() - frameStart;
+  govStats.frames++;
+  if (elapsed > budget) {
+    govStats.overruns++;
+    goodFrames = 0;
+    if (govLevel < GOV_LEVEL_MAX)
+      govLevel++;
+  } else if (elapsed < relax && govLevel
+	     && ++goodFrames == GOV_RELAX) {
+    goodFrames = 0;
+    govLevel--;
+  }
+}
+
+int
+gov_lowPriorityDue()
+{
+  return !(frameCount & ((1 << govLevel) - 1));
+}
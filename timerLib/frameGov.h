@@ -0,0 +1,38 @@
+#ifndef frameGov_included
+#define frameGov_included
+
+/** Frame governor
+ *
+ *  Main brackets each rendered frame with gov_frameBegin and
+ *  gov_frameEnd.  Render time is measured with Timer A1 against a
+ *  budget, and overruns are counted.
+ *
+ *  The governor adapts through govLevel: each overrun raises it, and a
+ *  run of GOV_RELAX frames within 3/4 of the budget lowers it.  Main
+ *  skips low priority drawing (HUD, static regions) unless
+ *  gov_lowPriorityDue, which is true one frame in 2^govLevel.
+ *  The governor never slows the simulation: main runs it in fixed
+ *  steps for the ticks that have passed (pong's simAdvance runs up to
+ *  4 a frame), so a long frame is followed by extra steps.
+ */
+
+#define GOV_LEVEL_MAX 3		/**< low priority drawing every 8th frame */
+#define GOV_RELAX 16		/**< good frames before the level drops */
+
+typedef struct {
+  unsigned int frames, overruns;
+} GovStats;
+
+extern GovStats govStats;
+extern unsigned char govLevel;
+
+/** Set the render budget and clear the statistics (starts Timer A1) */
+void gov_init(unsigned long budgetMicroseconds);
+
+void gov_frameBegin();
+void gov_frameEnd();
+
+/** True on frames that should also draw low priority regions */
+int gov_lowPriorityDue();
+
+#endif // included
@@ -3,5 +3,12 @@
 
 #include "clocksTimer.h"
 #include "sr.h"
+#include "scheduler.h"
+#include "workQueue.h"
+#include "timerA1.h"
+#include "tickless.h"
+#include "profiler.h"
+#include "dutyMeter.h"
+#include "frameGov.h"
 
 #endif // included
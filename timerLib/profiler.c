@@ -0,0 +1,49 @@
+#include "libTimer.h"
+#include "profiler.h"
+
+ProfZone profZones[PROF_ZONES];
+static unsigned long profStart[PROF_ZONES];
+
+void
+prof_reset()
+{
+  unsigned char zone;
+  timerA1Start();
+  for (zone = 0; zone < PROF_ZONES; zone++) {
+    ProfZone *z = &profZones[zone];
+    profStart[zone] = timerA1Now(); /* zones open across a reset start here */
+    z->total = 0;
+    z->count = 0;
+    z->min = 0xffff;
+    z->max = 0;
+  }
+}
+
+void
+prof_begin(unsigned char zone)
+{
+  profStart[zone] = timerA1Now();
+}
+
+void
+prof_end(unsigned char zone)
+{
+  unsigned long elapsed = timerA1Now() - profStart[zone];
+  unsigned int sat = elapsed > 0xffff ? 0xffff : elapsed;
+  ProfZone *z = &profZones[zone];
+  z->total += elapsed;
+  z->count++;
+  if (sat < z->min)
+    z->min = sat;
+  if (sat > z->max)
+    z->max = sat;
+}
+
+void
+prof_dump(void (*emit)(unsigned char zone, const ProfZone *z))
+{
+  unsigned char zone;
+  for (zone = 0; zone < PROF_ZONES; zone++)
+    if (profZones[zone].count)
+      emit(zone, &profZones[zone]);
+}
@@ -0,0 +1,50 @@
+#ifndef profiler_included
+#define profiler_included
+
+/** Zone profiler
+ *
+ *  prof_begin(zone) ... prof_end(zone) timestamps a stretch of code
+ *  with Timer A1 and accumulates its count, total, min and max.
+ *  Times are in Timer A1 counts, one per SMCLK cycle (one or more
+ *  CPU cycles: two in CLOCK_PROFILE_SPI_8MHZ, eight by default);
+ *  PROF_CYCLES converts them to CPU cycles.
+ *
+ *  Programs that define PROFILE before including this header can use
+ *  PROF_BEGIN and PROF_END, which compile to nothing otherwise.
+ */
+
+#ifndef PROF_ZONES
+#define PROF_ZONES 5		/**< 14 bytes of RAM each */
+#endif
+
+typedef struct {
+  unsigned long total;		/**< counts */
+  unsigned int count;		/**< times the zone was entered */
+  unsigned int min, max;	/**< counts, saturating at 0xffff */
+} ProfZone;
+
+extern ProfZone profZones[PROF_ZONES];
+
+/** Clear all zones and start Timer A1.  Zones open during the
+ *  reset are timed from the reset. */
+void prof_reset();
+
+void prof_begin(unsigned char zone);
+void prof_end(unsigned char zone);
+
+/** Hand each zone that has been entered to emit, e.g. to draw it
+ *  on the lcd or to copy it out to a host.
+ */
+void prof_dump(void (*emit)(unsigned char zone, const ProfZone *z));
+
+#define PROF_CYCLES(counts) ((unsigned long)(counts) << timerA1CycleShift)
+
+#ifdef PROFILE
+#define PROF_BEGIN(zone) prof_begin(zone)
+#define PROF_END(zone) prof_end(zone)
+#else
+#define PROF_BEGIN(zone)
+#define PROF_END(zone)
+#endif
+
+#endif // included
@@ -0,0 +1,127 @@
+#include "scheduler.h"
+
+typedef struct {
+  SchedFn fn;			/**< 0 if the slot is free */
+  void *arg;
+  unsigned int deadline, period;
+  unsigned char overruns;
+} SchedTimer;
+
+static SchedTimer timers[SCHED_CAPACITY];
+volatile unsigned int sched_now = 0;
+static volatile unsigned int nextDeadline;
+static volatile unsigned char active = 0; /**< number of slots in use */
+
+/** Deadlines are compared by their (signed) distance from now so that
+ *  sched_now may wrap */
+#define due(deadline) ((int)((deadline) - sched_now) <= 0)
+
+/** Index of the earliest active timer, or -1 */
+static int
+earliest()
+{
+  int i, best = -1;
+  for (i = 0; i < SCHED_CAPACITY; i++) {
+    if (timers[i].fn &&
+	(best < 0 || (int)(timers[i].deadline - timers[best].deadline) < 0))
+      best = i;
+  }
+  return best;
+}
+
+static void
+updateNextDeadline()
+{
+  int i = earliest();
+  if (i >= 0)
+    nextDeadline = timers[i].deadline;
+}
+
+int
+sched_add(SchedFn fn, void *arg, unsigned int delay, unsigned int period)
+{
+  int i;
+  for (i = 0; i < SCHED_CAPACITY; i++) {
+    SchedTimer *t = &timers[i];
+    if (!t->fn) {
+      t->arg = arg;
+      t->deadline = sched_now + delay;
+      t->period = period;
+      t->overruns = 0;
+      t->fn = fn;
+      active++;
+      updateNextDeadline();
+      return i;
+    }
+  }
+  return -1;
+}
+
+void
+sched_cancel(int handle)
+{
+  if (handle >= 0 && handle < SCHED_CAPACITY && timers[handle].fn) {
+    timers[handle].fn = 0;
+    active--;
+    updateNextDeadline();
+  }
+}
+
+unsigned char
+sched_overruns(int handle)
+{
+  return timers[handle].overruns;
+}
+
+int
+sched_tick()
+{
+  sched_now++;
+  return active && due(nextDeadline);
+}
+
+int
+sched_pending()
+{
+  return active && due(nextDeadline);
+}
+
+void
+sched_dispatch()
+{
+  int i;
+  while ((i = earliest()) >= 0 && due(timers[i].deadline)) {
+    SchedTimer *t = &timers[i];
+    SchedFn fn = t->fn;
+    void *arg = t->arg;
+    if (t->period) {		/* periodic: next deadline, skipping missed ones */
+      t->deadline += t->period;
+      while (due(t->deadline)) {
+	t->deadline += t->period;
+	if (t->overruns < 255)
+	  t->overruns++;
+      }
+    } else {			/* one-shot */
+      t->fn = 0;
+      active--;
+    }
+    updateNextDeadline();
+    fn(arg);
+  }
+}
+
+unsigned int
+sched_ticksUntilDue()
+{
+  int delta;
+  if (!active)
+    return 0xffff;
+  delta = nextDeadline - sched_now;
+  return delta > 0 ? delta : 0;
+}
+
+void
+sched_setNow(unsigned int now)
+{
+  sched_now = now;
+}
@@ -0,0 +1,59 @@
+#ifndef scheduler_included
+#define scheduler_included
+
+/** Cooperative scheduler on the watchdog tick
+ *
+ *  A fixed-capacity table of one-shot and periodic timers with tick
+ *  resolution.  The tick interrupt only counts (sched_tick); callbacks
+ *  run in main context (sched_dispatch), earliest deadline first.
+ *
+ *  A periodic timer that falls one or more whole periods behind
+ *  (because a callback or redraw ran long) has an overrun: the missed
+ *  periods are counted and skipped rather than run back to back.
+ */
+
+#ifndef SCHED_CAPACITY
+#define SCHED_CAPACITY 2	/**< 10 bytes of RAM each */
+#endif
+
+typedef void (*SchedFn)(void *arg);
+
+extern volatile unsigned int sched_now; /**< ticks since start (wraps) */
+
+/** Add a timer
+ *
+ *  \param fn Called from sched_dispatch as fn(arg)
+ *  \param delay Ticks until the first call
+ *  \param period Ticks between calls, or 0 for a one-shot
+ *  \return a handle, or -1 if the table is full
+ */
+int sched_add(SchedFn fn, void *arg, unsigned int delay, unsigned int period);
+
+/** Stop a timer (one-shots stop themselves after running) */
+void sched_cancel(int handle);
+
+/** Missed periods counted for a timer since it was added */
+unsigned char sched_overruns(int handle);
+
+/** Call from the tick interrupt.  
+ *  \return true if a timer is due (so main should be woken)
+ */
+int sched_tick();
+
+/** True if a timer is due */
+int sched_pending();
+
+/** Call from main: run every due timer, earliest deadline first */
+void sched_dispatch();
+
+/** Ticks until the earliest timer is due: 0 if one is due now,
+ *  0xffff if there are no timers
+ */
+unsigned int sched_ticksUntilDue();
+
+/** Set the tick count (when ticks come from a clock rather than
+ *  sched_tick, see tickless.h)
+ */
+void sched_setNow(unsigned int now);
+
+#endif // included
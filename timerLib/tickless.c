@@ -0,0 +1,53 @@
+#include <msp430.h>
+#include "libTimer.h"
+
+TicklessStats ticklessStats;
+static unsigned long epoch;	/**< Timer A1 count at tickless_init */
+
+void
+tickless_init()
+{
+  timerA1Start();
+  IE1 &= ~WDTIE;		/* no periodic tick */
+  epoch = timerA1Now() - ((unsigned long)sched_now << timerA1TickShift);
+}
+
+unsigned int
+tickless_now()
+{
+  return (timerA1Now() - epoch) >> timerA1TickShift;
+}
+
+void
+tickless_sleep()
+{
+  unsigned int ticks;
+  unsigned long start = timerA1Now(), target, now;
+
+  sched_setNow(tickless_now());
+  ticks = sched_ticksUntilDue();
+  if (!ticks)
+    return;
+  /* start of the current tick plus ticks (all relative, so wrap-safe) */
+  target = start - ((start - epoch) & ((1UL << timerA1TickShift) - 1))
+    + ((unsigned long)ticks << timerA1TickShift);
+  for (;;) {
+    and_sr(~8);			/* GIE off: the alarm can't fire before we sleep */
+    timerA1SetAlarm(target);	/* armed first, so a compare from here on wakes us */
+    now = timerA1Now();
+    if ((long)(target - now) <= 0) { /* passed, perhaps before the alarm was set */
+      timerA1ClearAlarm();
+      or_sr(8);
+      break;
+    }
+    or_sr(0x18);		/* CPU OFF and GIE on, atomically */
+    ticklessStats.wakeups++;
+    timerA1ClearAlarm();
+    if (!wq_empty())		/* another interrupt posted work for main */
+      break;
+  }
+  now = timerA1Now() - start;
+  ticklessStats.asleep += now;
+  ticklessStats.lastAsleep = now > 0xffff ? 0xffff : now;
+  sched_setNow(tickless_now());
+}
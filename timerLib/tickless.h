@@ -0,0 +1,34 @@
+#ifndef tickless_included
+#define tickless_included
+
+/** Tickless idle
+ *
+ *  Rather than waking on every watchdog tick, main sleeps until the
+ *  scheduler's next deadline, which is programmed into Timer A1.
+ *  Scheduler time (sched_now) then follows Timer A1's 32-bit count.
+ */
+
+/** Time spent asleep in tickless_sleep */
+typedef struct {
+  unsigned int wakeups;		/**< times the CPU woke (including early wakes) */
+  unsigned long asleep;		/**< Timer A1 counts spent in LPM */
+  unsigned int lastAsleep;	/**< counts asleep in the most recent tickless_sleep (saturates) */
+} TicklessStats;
+
+extern TicklessStats ticklessStats;
+
+/** Switch to tickless mode: starts Timer A1 and turns off the
+ *  watchdog tick interrupt.  Call with the scheduler already running.
+ */
+void tickless_init();
+
+/** Ticks since tickless_init, from Timer A1 */
+unsigned int tickless_now();
+
+/** From main: sleep in LPM0 until a scheduler timer is due (returns
+ *  at once if one already is), then bring sched_now up to date.
+ *  Interrupt handlers that need main sooner may wake it as usual.
+ */
+void tickless_sleep();
+
+#endif // included
@@ -0,0 +1,61 @@
+#include <msp430.h>
+#include "libTimer.h"
+
+volatile unsigned int timerA1Overflows = 0;
+static unsigned char started = 0;
+
+void
+timerA1Start()
+{
+  if (started)
+    return;
+  started = 1;
+  timerA1Overflows = 0;
+  // Timer A1 control:
+  //  Timer clock source 2: system clock (SMCLK), undivided
+  //  Mode Control 2: continuously 0...0xffff, interrupt on overflow
+  TA1CTL = TASSEL_2 + ID_0 + MC_2 + TACLR + TAIE;
+}
+
+unsigned long
+timerA1Now()
+{
+  unsigned int hi, lo;
+  do {				/* retry if an overflow was serviced meanwhile */
+    hi = timerA1Overflows;
+    lo = TA1R;
+  } while (hi != timerA1Overflows);
+  if ((TA1CTL & TAIFG) && lo < 0x8000) /* overflow not serviced yet (GIE off) */
+    hi++;
+  return ((unsigned long)hi << 16) | lo;
+}
+
+void
+timerA1SetAlarm(unsigned int target)
+{
+  TA1CCR0 = target;
+  TA1CCTL0 = CCIE;		/* clears any stale CCIFG */
+}
+
+void
+timerA1ClearAlarm()
+{
+  TA1CCTL0 = 0;
+}
+
+/* CCR0: alarm */
+void
+__interrupt_vec(TIMER1_A0_VECTOR) TimerA1_CCR0()
+{
+  TA1CCTL0 = 0;			/* one-shot */
+  __bic_SR_register_on_exit(CPUOFF); /* wake main */
+}
+
+/* overflow (and CCR1/CCR2, unused) */
+void
+__interrupt_vec(TIMER1_A1_VECTOR) TimerA1_Overflow()
+{
+  if (TA1IV == TA1IV_TAIFG) {	/* reading TA1IV clears the flag */
+    timerA1Overflows++;
+  }
+}
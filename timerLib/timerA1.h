@@ -0,0 +1,35 @@
+#ifndef timerA1_included
+#define timerA1_included
+
+/** Free-running time base on Timer A1
+ *
+ *  Timer A1 (otherwise unused) counts SMCLK continuously, undivided,
+ *  so the profiler resolves single SMCLK cycles; its overflows extend
+ *  the count to 32 bits.  One count is 1 << timerA1CycleShift CPU
+ *  cycles, and one tick is 1 << timerA1TickShift counts.  A tickless
+ *  sleep longer than one 16-bit period wakes early once per period
+ *  and sets its alarm again.
+ */
+
+#define timerA1CycleShift clockSmclkShift
+#define timerA1TickShift clockTickShift
+
+extern volatile unsigned int timerA1Overflows;
+
+/** Start counting from 0 (idempotent) */
+void timerA1Start();
+
+/** Counts since timerA1Start, 32 bits (about 35 minutes at 2MHz) */
+unsigned long timerA1Now();
+
+/** Interrupt when the count's low 16 bits next equal target.  For
+ *  targets more than one overflow away this fires early; the caller
+ *  checks timerA1Now and sets the alarm again.  A target the count
+ *  passes before the alarm is set doesn't fire until the count comes
+ *  round again, so check timerA1Now after setting it.
+ *  The alarm interrupt wakes the CPU from low power mode.
+ */
+void timerA1SetAlarm(unsigned int target);
+void timerA1ClearAlarm();
+
+#endif // included
@@ -0,0 +1,45 @@
+#include "workQueue.h"
+
+typedef struct {
+  WorkFn fn;
+  void *arg;
+} WorkItem;
+
+static WorkItem items[WQ_SIZE];
+static volatile unsigned char head = 0; /**< next free slot: written only by the producer */
+static volatile unsigned char tail = 0; /**< oldest item: written only by the consumer */
+volatile unsigned char wq_dropped = 0;
+
+#define WQ_MASK (WQ_SIZE - 1)
+
+int
+wq_post(WorkFn fn, void *arg)
+{
+  unsigned char h = head;
+  if (((h + 1) & WQ_MASK) == tail) { /* full */
+    wq_dropped++;
+    return 0;
+  }
+  items[h].fn = fn;
+  items[h].arg = arg;
+  head = (h + 1) & WQ_MASK;	/* publish only after the item is written */
+  return 1;
+}
+
+int
+wq_empty()
+{
+  return head == tail;
+}
+
+void
+wq_drain()
+{
+  unsigned char t;
+  while ((t = tail) != head) {
+    WorkFn fn = items[t].fn;
+    void *arg = items[t].arg;
+    tail = (t + 1) & WQ_MASK;	/* free the slot before running */
+    fn(arg);
+  }
+}
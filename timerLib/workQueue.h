@@ -0,0 +1,32 @@
+#ifndef workQueue_included
+#define workQueue_included
+
+/** Deferred work queue: interrupt handlers post small work items that
+ *  the main loop runs between frames, so handlers stay short and
+ *  interrupt latency stays bounded.
+ *
+ *  Lock-free single-producer/single-consumer ring.  Interrupts do not
+ *  nest on the msp430 (GIE is cleared on entry), so all interrupt
+ *  handlers together are the single producer; main is the consumer.
+ */
+
+#ifndef WQ_SIZE
+#define WQ_SIZE 4		/**< a power of two; holds WQ_SIZE-1 items, 4 bytes each */
+#endif
+
+typedef void (*WorkFn)(void *arg);
+
+extern volatile unsigned char wq_dropped; /**< posts refused because the queue was full */
+
+/** Post fn(arg) from an interrupt handler
+ *  \return true if queued, false if the queue was full
+ */
+int wq_post(WorkFn fn, void *arg);
+
+/** True if nothing is queued */
+int wq_empty();
+
+/** From main: run queued items, oldest first, until the queue is empty */
+void wq_drain();
+
+#endif // included